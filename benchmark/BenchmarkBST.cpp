@@ -2,45 +2,81 @@
 
 #include <vector>
 
+#include "BenchmarkUtils.h"
+#include "src/AdaptiveRadixTree/AdaptiveRadixTree.h"
+#include "src/CATree/CATree.h"
 #include "src/CGLBBST/CGLBBST.h"
 #include "src/CoarseGrainedLockingBST/CGLBST.h"
 #include "src/FineGrainedLockingBST/FGLBST.h"
+#include "src/FlatCombiningBST/FlatCombiningBST.h"
 #include "src/NatarajanBST/NatarajanBST.h"
 #include "src/SinghBBST/SinghBBST.h"
+#include "src/SortedArraySet/SortedArraySet.h"
 
 constexpr int SETUP_ELEMS = 32768;
 constexpr int TOTAL_ELEMS = 524288;
 constexpr int MIN_THREADS = 2;
 constexpr int MAX_THREADS = 32;
+// Levels of the routing index updates start below
+constexpr int ROUTING_LEVELS = 8;
 
-void createBalancedInsertion(std::vector<int>& container, int start, int end) {
-  if (start > end)
-    return;
-  int mid = start + (end - start) / 2;
-  container.push_back(mid);
-  createBalancedInsertion(container, start, mid - 1);
-  createBalancedInsertion(container, mid + 1, end);
+template <class Tree>
+struct Routed : Tree {
+  Routed() { this->set_routing_levels(ROUTING_LEVELS); }
+};
+
+template <typename BST>
+void prefill(BST& bst) {
+  prefillBalanced(bst, SETUP_ELEMS);
 }
 
+// All threads look up their share of keys in one tree, most of them above
+// the prefilled ones
 template <typename BST>
 static void BM_READ_INTENSIVE(benchmark::State& state) {
-  BST bst;
-  std::vector<int> elems;
+  pinThread(state);
   const int tid = state.thread_index();
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
+  setupSharedTree<BST>(state, prefill<BST>);
 
-  if (tid == 0) {
-    createBalancedInsertion(elems, 0, SETUP_ELEMS - 1);
-    for (const int elem : elems)
-      bst.insert(elem);
+  resetOpCounters(state);
+  resetLockProfile(state);
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (int i = CAPACITY_PER_THREAD * tid, e = CAPACITY_PER_THREAD * (tid + 1);
+         i < e; i++) {
+      benchmark::DoNotOptimize(bst[i]);
+    }
   }
+  state.SetItemsProcessed(state.iterations() * CAPACITY_PER_THREAD);
+
+  reportOpCounters(state);
+  reportLockProfile(state, __PRETTY_FUNCTION__);
+  teardownSharedTree<BST>(state);
+}
+
+// As BM_READ_INTENSIVE, but every lookup hits a prefilled key
+template <typename BST>
+static void BM_READ_HITS(benchmark::State& state) {
+  pinThread(state);
+  const int tid = state.thread_index();
+  const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
+  setupSharedTree<BST>(state, prefill<BST>);
 
+  resetOpCounters(state);
+  resetLockProfile(state);
   for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
     for (int i = CAPACITY_PER_THREAD * tid, e = CAPACITY_PER_THREAD * (tid + 1);
          i < e; i++) {
-      benchmark::DoNotOptimize(bst[i]);
+      benchmark::DoNotOptimize(bst[i % SETUP_ELEMS]);
     }
   }
+  state.SetItemsProcessed(state.iterations() * CAPACITY_PER_THREAD);
+
+  reportOpCounters(state);
+  reportLockProfile(state, __PRETTY_FUNCTION__);
+  teardownSharedTree<BST>(state);
 }
 
 static void BM_READ_INTENSIVE_SINGLE_THREADED(benchmark::State& state) {
@@ -57,25 +93,22 @@ static void BM_READ_INTENSIVE_SINGLE_THREADED(benchmark::State& state) {
       benchmark::DoNotOptimize(bst.find(i) != bst.end());
     }
   }
+  state.SetItemsProcessed(state.iterations() * CAPACITY_PER_THREAD);
 }
 
 template <typename BST>
 static void BM_READ_WRITE(benchmark::State& state) {
-  BST bst;
+  pinThread(state);
   std::vector<int> elems;
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
   const int tid = state.thread_index();
+  createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
+  setupSharedTree<BST>(state, prefill<BST>);
 
-  if (tid == 0) {
-    std::vector<int> initial;
-    createBalancedInsertion(initial, 0, SETUP_ELEMS - 1);
-    for (const int initialElem : initial)
-      bst.insert(initialElem);
-
-    createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
-  }
-
+  resetOpCounters(state);
+  resetLockProfile(state);
   for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
     for (const int elem : elems) {
       const int toBeInserted = TOTAL_ELEMS + CAPACITY_PER_THREAD * tid + elem;
       bst.insert(toBeInserted);
@@ -84,6 +117,11 @@ static void BM_READ_WRITE(benchmark::State& state) {
       bst.remove(toBeInserted);
     }
   }
+  state.SetItemsProcessed(state.iterations() * elems.size());
+
+  reportOpCounters(state);
+  reportLockProfile(state, __PRETTY_FUNCTION__);
+  teardownSharedTree<BST>(state);
 }
 
 static void BM_READ_WRITE_SINGLE_THREADED(benchmark::State& state) {
@@ -106,31 +144,33 @@ static void BM_READ_WRITE_SINGLE_THREADED(benchmark::State& state) {
       bst.erase(toBeInserted);
     }
   }
+  state.SetItemsProcessed(state.iterations() * elems.size());
 }
 
 template <typename BST>
 static void BM_WRITE_INTENSIVE(benchmark::State& state) {
-  BST bst;
+  pinThread(state);
   std::vector<int> elems;
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
   const int tid = state.thread_index();
+  createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
+  setupSharedTree<BST>(state, prefill<BST>);
 
-  if (tid == 0) {
-    std::vector<int> initial;
-    createBalancedInsertion(initial, 0, SETUP_ELEMS - 1);
-    for (const int initialElem : initial)
-      bst.insert(initialElem);
-
-    createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
-  }
-
+  resetOpCounters(state);
+  resetLockProfile(state);
   for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
     for (const int elem : elems) {
       const int toBeInserted = TOTAL_ELEMS + CAPACITY_PER_THREAD * tid + elem;
       bst.insert(toBeInserted);
       bst.remove(toBeInserted);
     }
   }
+  state.SetItemsProcessed(state.iterations() * elems.size());
+
+  reportOpCounters(state);
+  reportLockProfile(state, __PRETTY_FUNCTION__);
+  teardownSharedTree<BST>(state);
 }
 
 static void BM_WRITE_INTENSIVE_SINGLE_THREADED(benchmark::State& state) {
@@ -152,6 +192,7 @@ static void BM_WRITE_INTENSIVE_SINGLE_THREADED(benchmark::State& state) {
       bst.erase(toBeInserted);
     }
   }
+  state.SetItemsProcessed(state.iterations() * elems.size());
 }
 
 BENCHMARK(BM_READ_INTENSIVE<NatarajanBST<int>>)
@@ -162,10 +203,27 @@ BENCHMARK(BM_READ_INTENSIVE<CGLBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_INTENSIVE<CGLBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK_TEMPLATE(BM_READ_INTENSIVE, CGLBST<int, BigReaderLock>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK_TEMPLATE(BM_READ_INTENSIVE, CGLBBST<int, BigReaderLock>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_INTENSIVE<SortedArraySet<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_INTENSIVE<CATree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_INTENSIVE<SinghBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_INTENSIVE<AdaptiveRadixTree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_INTENSIVE_SINGLE_THREADED);
 
+BENCHMARK(BM_READ_HITS<NatarajanBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_HITS<FGLBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_HITS<CGLBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_HITS<CGLBBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_HITS<SinghBBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+
 BENCHMARK(BM_WRITE_INTENSIVE<NatarajanBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_WRITE_INTENSIVE<FGLBST<int>>)
@@ -174,8 +232,20 @@ BENCHMARK(BM_WRITE_INTENSIVE<CGLBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_WRITE_INTENSIVE<CGLBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_WRITE_INTENSIVE<FlatCombiningBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK_TEMPLATE(BM_WRITE_INTENSIVE, FlatCombiningBST<int, CGLBBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_WRITE_INTENSIVE<CATree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_WRITE_INTENSIVE<SinghBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_WRITE_INTENSIVE<Routed<NatarajanBST<int>>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_WRITE_INTENSIVE<Routed<SinghBBST<int>>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_WRITE_INTENSIVE<AdaptiveRadixTree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_WRITE_INTENSIVE_SINGLE_THREADED);
 
 BENCHMARK(BM_READ_WRITE<NatarajanBST<int>>)
@@ -183,7 +253,18 @@ BENCHMARK(BM_READ_WRITE<NatarajanBST<int>>)
 BENCHMARK(BM_READ_WRITE<FGLBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_WRITE<CGLBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_WRITE<CGLBBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK_TEMPLATE(BM_READ_WRITE, CGLBST<int, BigReaderLock>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK_TEMPLATE(BM_READ_WRITE, CGLBBST<int, BigReaderLock>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE<CATree<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_WRITE<SinghBBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE<Routed<NatarajanBST<int>>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE<Routed<SinghBBST<int>>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE<AdaptiveRadixTree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_WRITE_SINGLE_THREADED);
 
 BENCHMARK_MAIN();
\ No newline at end of file
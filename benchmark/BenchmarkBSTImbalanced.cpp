@@ -1,6 +1,11 @@
 #include <benchmark/benchmark.h>
 
+#include <limits>
 #include <vector>
+
+#include "BenchmarkUtils.h"
+#include "src/AdaptiveRadixTree/AdaptiveRadixTree.h"
+#include "src/CATree/CATree.h"
 #include "src/CGLBBST/CGLBBST.h"
 #include "src/CoarseGrainedLockingBST/CGLBST.h"
 #include "src/NatarajanBST/NatarajanBST.h"
@@ -10,36 +15,39 @@ constexpr int SETUP_ELEMS = 32768;
 constexpr int TOTAL_ELEMS = 524288;
 constexpr int MIN_THREADS = 2;
 constexpr int MAX_THREADS = 32;
+constexpr int LIM = std::numeric_limits<int>::max() - 3;
 
-void createBalancedInsertion(std::vector<int>& container, int start, int end) {
-  if (start > end)
-    return;
-  int mid = start + (end - start) / 2;
-  container.push_back(mid);
-  createBalancedInsertion(container, start, mid - 1);
-  createBalancedInsertion(container, mid + 1, end);
+// Keys LIM - SETUP_ELEMS + 1 to LIM inserted in descending order, a tree that
+// does not rebalance degenerates into a list
+template <typename BST>
+void prefill(BST& bst) {
+  for (int i = 0; i < SETUP_ELEMS; i++)
+    bst.insert(LIM - i);
 }
 
+// All threads look up their share of keys in one tree
 template <typename BST>
 static void BM_READ_INTENSIVE_IMBALANCED(benchmark::State& state) {
-  BST bst;
-  std::vector<int> elems;
+  pinThread(state);
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
   const int tid = state.thread_index();
+  setupSharedTree<BST>(state, prefill<BST>);
 
-  if (tid == 0) {
-    for (int i = 0, lim = std::numeric_limits<int>::max() - 3; i < SETUP_ELEMS;
-         i++) {
-      bst.insert(lim - i);
-    }
-  }
-
+  resetOpCounters(state);
+  resetLockProfile(state);
   for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
     for (int i = CAPACITY_PER_THREAD * tid, e = CAPACITY_PER_THREAD * (tid + 1);
          i < e; i++) {
       benchmark::DoNotOptimize(bst[i]);
     }
   }
+  state.SetItemsProcessed(state.iterations() * CAPACITY_PER_THREAD);
+
+  reportOpCounters(state);
+  reportLockProfile(state, __PRETTY_FUNCTION__);
+  reportShape(state, *sharedTree<BST>);
+  teardownSharedTree<BST>(state);
 }
 
 static void BM_READ_INTENSIVE_IMBALANCED_SINGLE_THREADED(
@@ -48,35 +56,30 @@ static void BM_READ_INTENSIVE_IMBALANCED_SINGLE_THREADED(
   std::vector<int> elems;
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS;
 
-  for (int i = 0, lim = std::numeric_limits<int>::max() - 3; i < SETUP_ELEMS;
-       i++) {
-    bst.insert(lim - i);
-  }
+  for (int i = 0; i < SETUP_ELEMS; i++)
+    bst.insert(LIM - i);
 
   for (auto _ : state) {
     for (int i = 0, e = CAPACITY_PER_THREAD; i < e; i++) {
       benchmark::DoNotOptimize(bst.find(i) != bst.end());
     }
   }
+  state.SetItemsProcessed(state.iterations() * CAPACITY_PER_THREAD);
 }
 
 template <typename BST>
 static void BM_READ_WRITE_IMBALANCED(benchmark::State& state) {
-  BST bst;
+  pinThread(state);
   std::vector<int> elems;
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
   const int tid = state.thread_index();
+  createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
+  setupSharedTree<BST>(state, prefill<BST>);
 
-  if (tid == 0) {
-    for (int i = 0, lim = std::numeric_limits<int>::max() - 3; i < SETUP_ELEMS;
-         i++) {
-      bst.insert(lim - i);
-    }
-
-    createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
-  }
-
+  resetOpCounters(state);
+  resetLockProfile(state);
   for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
     for (const int elem : elems) {
       const int toBeInserted = TOTAL_ELEMS + CAPACITY_PER_THREAD * tid + elem;
       bst.insert(toBeInserted);
@@ -85,6 +88,12 @@ static void BM_READ_WRITE_IMBALANCED(benchmark::State& state) {
       bst.remove(toBeInserted);
     }
   }
+  state.SetItemsProcessed(state.iterations() * elems.size());
+
+  reportOpCounters(state);
+  reportLockProfile(state, __PRETTY_FUNCTION__);
+  reportShape(state, *sharedTree<BST>);
+  teardownSharedTree<BST>(state);
 }
 
 static void BM_READ_WRITE_IMBALANCED_SINGLE_THREADED(benchmark::State& state) {
@@ -92,10 +101,8 @@ static void BM_READ_WRITE_IMBALANCED_SINGLE_THREADED(benchmark::State& state) {
   std::vector<int> elems;
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS;
 
-  for (int i = 0, lim = std::numeric_limits<int>::max() - 3; i < SETUP_ELEMS;
-       i++) {
-    bst.insert(lim - i);
-  }
+  for (int i = 0; i < SETUP_ELEMS; i++)
+    bst.insert(LIM - i);
 
   createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
 
@@ -108,31 +115,34 @@ static void BM_READ_WRITE_IMBALANCED_SINGLE_THREADED(benchmark::State& state) {
       bst.erase(toBeInserted);
     }
   }
+  state.SetItemsProcessed(state.iterations() * elems.size());
 }
 
 template <typename BST>
 static void BM_WRITE_INTENSIVE_IMBALANCED(benchmark::State& state) {
-  BST bst;
+  pinThread(state);
   std::vector<int> elems;
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
   const int tid = state.thread_index();
+  createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
+  setupSharedTree<BST>(state, prefill<BST>);
 
-  if (tid == 0) {
-    for (int i = 0, lim = std::numeric_limits<int>::max() - 3; i < SETUP_ELEMS;
-         i++) {
-      bst.insert(lim - i);
-    }
-
-    createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
-  }
-
+  resetOpCounters(state);
+  resetLockProfile(state);
   for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
     for (const int elem : elems) {
       const int toBeInserted = TOTAL_ELEMS + CAPACITY_PER_THREAD * tid + elem;
       benchmark::DoNotOptimize(bst.insert(toBeInserted));
       benchmark::DoNotOptimize(bst.remove(toBeInserted));
     }
   }
+  state.SetItemsProcessed(state.iterations() * elems.size());
+
+  reportOpCounters(state);
+  reportLockProfile(state, __PRETTY_FUNCTION__);
+  reportShape(state, *sharedTree<BST>);
+  teardownSharedTree<BST>(state);
 }
 
 static void BM_WRITE_INTENSIVE_IMBALANCED_SINGLE_THREADED(
@@ -141,10 +151,8 @@ static void BM_WRITE_INTENSIVE_IMBALANCED_SINGLE_THREADED(
   std::vector<int> elems;
   const int CAPACITY_PER_THREAD = TOTAL_ELEMS;
 
-  for (int i = 0, lim = std::numeric_limits<int>::max() - 3; i < SETUP_ELEMS;
-       i++) {
-    bst.insert(lim - i);
-  }
+  for (int i = 0; i < SETUP_ELEMS; i++)
+    bst.insert(LIM - i);
 
   createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
 
@@ -155,6 +163,7 @@ static void BM_WRITE_INTENSIVE_IMBALANCED_SINGLE_THREADED(
       bst.erase(toBeInserted);
     }
   }
+  state.SetItemsProcessed(state.iterations() * elems.size());
 }
 
 BENCHMARK(BM_READ_INTENSIVE_IMBALANCED<NatarajanBST<int>>)
@@ -163,8 +172,12 @@ BENCHMARK(BM_READ_INTENSIVE_IMBALANCED<CGLBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_INTENSIVE_IMBALANCED<CGLBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_INTENSIVE_IMBALANCED<CATree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_INTENSIVE_IMBALANCED<SinghBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_INTENSIVE_IMBALANCED<AdaptiveRadixTree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_INTENSIVE_IMBALANCED_SINGLE_THREADED);
 
 BENCHMARK(BM_WRITE_INTENSIVE_IMBALANCED<NatarajanBST<int>>)
@@ -173,8 +186,12 @@ BENCHMARK(BM_WRITE_INTENSIVE_IMBALANCED<CGLBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_WRITE_INTENSIVE_IMBALANCED<CGLBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_WRITE_INTENSIVE_IMBALANCED<CATree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_WRITE_INTENSIVE_IMBALANCED<SinghBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_WRITE_INTENSIVE_IMBALANCED<AdaptiveRadixTree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_WRITE_INTENSIVE_IMBALANCED_SINGLE_THREADED);
 
 BENCHMARK(BM_READ_WRITE_IMBALANCED<NatarajanBST<int>>)
@@ -183,8 +200,12 @@ BENCHMARK(BM_READ_WRITE_IMBALANCED<CGLBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_WRITE_IMBALANCED<CGLBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE_IMBALANCED<CATree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_WRITE_IMBALANCED<SinghBBST<int>>)
     ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE_IMBALANCED<AdaptiveRadixTree<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
 BENCHMARK(BM_READ_WRITE_IMBALANCED_SINGLE_THREADED);
 
 BENCHMARK_MAIN();
\ No newline at end of file
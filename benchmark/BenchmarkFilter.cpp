@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "src/FilteredBST/FilteredBST.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+
+// Even keys below 2 * SETUP_ELEMS are present, odd ones never are
+constexpr int SETUP_ELEMS = 32768;
+constexpr int TOTAL_ELEMS = 524288;
+constexpr int MIN_THREADS = 1;
+constexpr int MAX_THREADS = 32;
+
+template <typename BST>
+void prefill(BST& bst) {
+  prefillBalanced(bst, SETUP_ELEMS, 2);
+}
+
+// Point lookups of which the first argument is the percentage of hits
+template <typename BST>
+static void BM_LOOKUP(benchmark::State& state) {
+  pinThread(state);
+  const int tid = state.thread_index();
+  const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
+  std::mt19937 gen{prefillSeed() + tid};
+  std::uniform_int_distribution<int> keyDist{0, SETUP_ELEMS - 1},
+      percentDist{0, 99};
+  std::vector<int> keys;
+  keys.reserve(CAPACITY_PER_THREAD);
+  for (int i = 0; i < CAPACITY_PER_THREAD; i++) {
+    const bool hit = percentDist(gen) < state.range(0);
+    keys.push_back(2 * keyDist(gen) + !hit);
+  }
+  setupSharedTree<BST>(state, prefill<BST>);
+
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (const int key : keys)
+      benchmark::DoNotOptimize(bst[key]);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+  teardownSharedTree<BST>(state);
+}
+
+// Updates pay for the tree and the filter
+template <typename BST>
+static void BM_UPDATE(benchmark::State& state) {
+  pinThread(state);
+  const int tid = state.thread_index();
+  const int CAPACITY_PER_THREAD = SETUP_ELEMS / state.threads();
+  std::vector<int> elems;
+  createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
+  setupSharedTree<BST>(state, prefill<BST>);
+
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (const int elem : elems) {
+      const int toBeInserted = 2 * (CAPACITY_PER_THREAD * tid + elem) + 1;
+      benchmark::DoNotOptimize(bst.insert(toBeInserted));
+      benchmark::DoNotOptimize(bst.remove(toBeInserted));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * elems.size());
+  teardownSharedTree<BST>(state);
+}
+
+BENCHMARK(BM_LOOKUP<NatarajanBST<int>>)
+    ->DenseRange(0, 100, 25)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_LOOKUP<FilteredBST<int>>)
+    ->DenseRange(0, 100, 25)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK(BM_UPDATE<NatarajanBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_UPDATE<FilteredBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "src/HashIndexedBST/HashIndexedBST.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+
+constexpr int SETUP_ELEMS = 32768;
+constexpr int TOTAL_ELEMS = 524288;
+constexpr int MIN_THREADS = 1;
+constexpr int MAX_THREADS = 32;
+
+template <typename BST>
+void prefill(BST& bst) {
+  prefillBalanced(bst, SETUP_ELEMS);
+}
+
+// Point lookups, most of which miss
+template <typename BST>
+static void BM_POINT_LOOKUP(benchmark::State& state) {
+  pinThread(state);
+  const int tid = state.thread_index();
+  const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
+  setupSharedTree<BST>(state, prefill<BST>);
+
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (int i = CAPACITY_PER_THREAD * tid, e = CAPACITY_PER_THREAD * (tid + 1);
+         i < e; i++) {
+      benchmark::DoNotOptimize(bst[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * CAPACITY_PER_THREAD);
+  teardownSharedTree<BST>(state);
+}
+
+// Point lookups of present keys only
+template <typename BST>
+static void BM_POINT_LOOKUP_HIT(benchmark::State& state) {
+  pinThread(state);
+  const int tid = state.thread_index();
+  const int CAPACITY_PER_THREAD = SETUP_ELEMS / state.threads();
+  setupSharedTree<BST>(state, prefill<BST>);
+
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (int i = CAPACITY_PER_THREAD * tid, e = CAPACITY_PER_THREAD * (tid + 1);
+         i < e; i++) {
+      benchmark::DoNotOptimize(bst[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * CAPACITY_PER_THREAD);
+  teardownSharedTree<BST>(state);
+}
+
+// Updates pay for the tree and the index
+template <typename BST>
+static void BM_UPDATE(benchmark::State& state) {
+  pinThread(state);
+  const int tid = state.thread_index();
+  const int CAPACITY_PER_THREAD = TOTAL_ELEMS / state.threads();
+  std::vector<int> elems;
+  createBalancedInsertion(elems, 0, CAPACITY_PER_THREAD - 1);
+  setupSharedTree<BST>(state, prefill<BST>);
+
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (const int elem : elems) {
+      const int toBeInserted = TOTAL_ELEMS + CAPACITY_PER_THREAD * tid + elem;
+      benchmark::DoNotOptimize(bst.insert(toBeInserted));
+      benchmark::DoNotOptimize(bst.remove(toBeInserted));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * elems.size());
+  teardownSharedTree<BST>(state);
+}
+
+BENCHMARK(BM_POINT_LOOKUP<NatarajanBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_POINT_LOOKUP<HashIndexedBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK(BM_POINT_LOOKUP_HIT<NatarajanBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_POINT_LOOKUP_HIT<HashIndexedBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK(BM_UPDATE<NatarajanBST<int>>)->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_UPDATE<HashIndexedBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,169 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <typeindex>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "src/AdaptiveRadixTree/AdaptiveRadixTree.h"
+#include "src/BLinkTree/BLinkTree.h"
+#include "src/FreezableBST/FreezableBST.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+#include "src/SinghBBST/SinghBBST.h"
+
+constexpr int64_t MIN_ELEMS = 1'000'000;
+constexpr int64_t MAX_ELEMS = 100'000'000;
+constexpr int OPS_PER_THREAD = 1 << 20;
+constexpr int MIN_THREADS = 2;
+constexpr int MAX_THREADS = 32;
+
+// Building a 100M key tree dominates the run time, so the last tree built is
+// reused across thread counts and only dropped once another one is needed.
+std::shared_ptr<void> cachedTree;
+std::type_index cachedType = typeid(void);
+int64_t cachedSize = 0;
+
+template <typename BST>
+BST* prefilledTree(int64_t size) {
+  if (cachedTree == nullptr || cachedType != typeid(BST) ||
+      cachedSize != size) {
+    cachedTree.reset();
+
+    // Even keys are present, so half of the uniform lookups miss
+    std::vector<int> keys(size);
+    for (int64_t i = 0; i < size; i++)
+      keys[i] = static_cast<int>(2 * i);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{prefillSeed()});
+
+    Numa::ScopedPlacement placement{sharedPlacement()};
+    auto tree = std::make_shared<BST>();
+    for (const int key : keys)
+      tree->insert(key);
+
+    cachedTree = tree;
+    cachedType = typeid(BST);
+    cachedSize = size;
+  }
+  return static_cast<BST*>(cachedTree.get());
+}
+
+template <typename BST>
+static void BM_LOOKUP_LARGE(benchmark::State& state) {
+  pinThread(state);
+  const int64_t size = state.range(0);
+  const int tid = state.thread_index();
+  std::mt19937 gen{prefillSeed() + tid};
+  std::uniform_int_distribution<int> keyDist{0, static_cast<int>(2 * size - 1)};
+
+  if (tid == 0)
+    sharedTree<BST> = prefilledTree<BST>(size);
+
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+      benchmark::DoNotOptimize(bst[keyDist(gen)]);
+  }
+  state.SetItemsProcessed(state.iterations() * OPS_PER_THREAD);
+  if (tid == 0)
+    reportMemory(state, *sharedTree<BST>);
+}
+
+// Lookups in a tree that was frozen if the second argument is 1 and thawed
+// otherwise. The cached tree is frozen or thawed in place before the run.
+template <typename BST>
+static void BM_LOOKUP_FREEZABLE(benchmark::State& state) {
+  pinThread(state);
+  const int64_t size = state.range(0);
+  const int tid = state.thread_index();
+  std::mt19937 gen{prefillSeed() + tid};
+  std::uniform_int_distribution<int> keyDist{0, static_cast<int>(2 * size - 1)};
+
+  if (tid == 0) {
+    sharedTree<BST> = prefilledTree<BST>(size);
+    if (state.range(1) == 1)
+      sharedTree<BST>->freeze();
+    else
+      sharedTree<BST>->thaw();
+  }
+
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (int i = 0; i < OPS_PER_THREAD; i++)
+      benchmark::DoNotOptimize(bst[keyDist(gen)]);
+  }
+  state.SetItemsProcessed(state.iterations() * OPS_PER_THREAD);
+  if (tid == 0) {
+    reportMemory(state, *sharedTree<BST>);
+    reportShape(state, *sharedTree<BST>);
+  }
+}
+
+template <typename BST>
+static void BM_READ_WRITE_LARGE(benchmark::State& state) {
+  pinThread(state);
+  const int64_t size = state.range(0);
+  const int tid = state.thread_index();
+  std::mt19937 gen{prefillSeed() + tid};
+  std::uniform_int_distribution<int> keyDist{0, static_cast<int>(size - 1)};
+
+  if (tid == 0)
+    sharedTree<BST> = prefilledTree<BST>(size);
+
+  // Odd keys are absent, inserting and removing one keeps the size constant
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (int i = 0; i < OPS_PER_THREAD; i += 4) {
+      const int present = 2 * keyDist(gen), absent = 2 * keyDist(gen) + 1;
+      benchmark::DoNotOptimize(bst[present]);
+      benchmark::DoNotOptimize(bst.insert(absent));
+      benchmark::DoNotOptimize(bst[absent]);
+      benchmark::DoNotOptimize(bst.remove(absent));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * OPS_PER_THREAD);
+  if (tid == 0)
+    reportMemory(state, *sharedTree<BST>);
+}
+
+BENCHMARK(BM_LOOKUP_LARGE<BLinkTree<int>>)
+    ->RangeMultiplier(10)
+    ->Range(MIN_ELEMS, MAX_ELEMS)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_LOOKUP_LARGE<NatarajanBST<int>>)
+    ->RangeMultiplier(10)
+    ->Range(MIN_ELEMS, MAX_ELEMS)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_LOOKUP_LARGE<SinghBBST<int>>)
+    ->RangeMultiplier(10)
+    ->Range(MIN_ELEMS, MAX_ELEMS)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_LOOKUP_LARGE<AdaptiveRadixTree<int>>)
+    ->RangeMultiplier(10)
+    ->Range(MIN_ELEMS, MAX_ELEMS)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+// Thawed and frozen runs of one size share the tree
+BENCHMARK(BM_LOOKUP_FREEZABLE<FreezableBST<int>>)
+    ->ArgsProduct({benchmark::CreateRange(MIN_ELEMS, MAX_ELEMS, 10), {0, 1}})
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK(BM_READ_WRITE_LARGE<BLinkTree<int>>)
+    ->RangeMultiplier(10)
+    ->Range(MIN_ELEMS, MAX_ELEMS)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE_LARGE<NatarajanBST<int>>)
+    ->RangeMultiplier(10)
+    ->Range(MIN_ELEMS, MAX_ELEMS)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE_LARGE<SinghBBST<int>>)
+    ->RangeMultiplier(10)
+    ->Range(MIN_ELEMS, MAX_ELEMS)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_READ_WRITE_LARGE<AdaptiveRadixTree<int>>)
+    ->RangeMultiplier(10)
+    ->Range(MIN_ELEMS, MAX_ELEMS)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "src/BLinkTree/NodeSearch.h"
+
+constexpr int MIN_NODE_KEYS = 8;
+constexpr int MAX_NODE_KEYS = 256;
+constexpr int QUERIES = 4096;
+constexpr unsigned SEED = 42;
+
+// Linear scan without vector instructions, for reference
+template <class T>
+struct LinearSearch {
+  static std::size_t lowerBound(const T* keys, std::size_t n, const T& key) {
+    std::size_t i = 0;
+    for (; i < n && keys[i] < key; i++)
+      ;
+    return i;
+  }
+};
+
+template <class Search, class T>
+static void BM_NODE_SEARCH(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  std::vector<T> keys(n), queries(QUERIES);
+  for (std::size_t i = 0; i < n; i++)
+    keys[i] = static_cast<T>(2 * i);
+
+  std::mt19937 gen{SEED};
+  std::uniform_int_distribution<int64_t> keyDist{0,
+                                                 static_cast<int64_t>(2 * n)};
+  for (T& query : queries)
+    query = static_cast<T>(keyDist(gen));
+
+  for (auto _ : state) {
+    for (const T& query : queries)
+      benchmark::DoNotOptimize(Search::lowerBound(keys.data(), n, query));
+  }
+  state.SetItemsProcessed(state.iterations() * QUERIES);
+}
+
+BENCHMARK(BM_NODE_SEARCH<BLink::ScalarSearch<int32_t>, int32_t>)
+    ->RangeMultiplier(2)
+    ->Range(MIN_NODE_KEYS, MAX_NODE_KEYS);
+BENCHMARK(BM_NODE_SEARCH<LinearSearch<int32_t>, int32_t>)
+    ->RangeMultiplier(2)
+    ->Range(MIN_NODE_KEYS, MAX_NODE_KEYS);
+BENCHMARK(BM_NODE_SEARCH<BLink::SimdSearch<int32_t>, int32_t>)
+    ->RangeMultiplier(2)
+    ->Range(MIN_NODE_KEYS, MAX_NODE_KEYS);
+
+BENCHMARK(BM_NODE_SEARCH<BLink::ScalarSearch<int64_t>, int64_t>)
+    ->RangeMultiplier(2)
+    ->Range(MIN_NODE_KEYS, MAX_NODE_KEYS);
+BENCHMARK(BM_NODE_SEARCH<LinearSearch<int64_t>, int64_t>)
+    ->RangeMultiplier(2)
+    ->Range(MIN_NODE_KEYS, MAX_NODE_KEYS);
+BENCHMARK(BM_NODE_SEARCH<BLink::SimdSearch<int64_t>, int64_t>)
+    ->RangeMultiplier(2)
+    ->Range(MIN_NODE_KEYS, MAX_NODE_KEYS);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+#include "src/SinghBBST/SinghBBST.h"
+
+constexpr int QUEUE_ELEMS = 65536;
+constexpr int TOTAL_OPS = 262144;
+constexpr int MIN_THREADS = 2;
+constexpr int MAX_THREADS = 32;
+// Spray of the relaxed runs, pops spread over about 2^SPRAY keys
+constexpr int SPRAY = 6;
+
+// What the trees replace, a std::set behind one mutex
+struct LockedSet {
+  bool insert(int key) {
+    std::lock_guard lk{mut};
+    return keys.insert(key).second;
+  }
+
+  std::optional<int> try_pop_min(int) {
+    std::lock_guard lk{mut};
+    if (keys.empty())
+      return std::nullopt;
+    const int key = *keys.begin();
+    keys.erase(keys.begin());
+    return key;
+  }
+
+  // A red-black tree node holds three pointers and its colour next to the
+  // key
+  MemoryStats memory_stats() {
+    MemoryStats stats;
+    stats.keys = stats.liveNodes = keys.size();
+    stats.liveBytes = keys.size() * (4 * sizeof(void*) + sizeof(int));
+    return stats;
+  }
+
+ private:
+  std::mutex mut;
+  std::set<int> keys;
+};
+
+template <typename Queue>
+void prefill(Queue& queue) {
+  std::vector<int> keys(QUEUE_ELEMS);
+  for (int i = 0; i < QUEUE_ELEMS; i++)
+    keys[i] = i;
+  std::shuffle(keys.begin(), keys.end(), std::mt19937{prefillSeed()});
+  for (const int key : keys)
+    queue.insert(key);
+}
+
+// Timer wheel: every thread pops the earliest deadline and schedules it again
+// up to 2 * QUEUE_ELEMS later, retrying deadlines that are taken, which keeps
+// the queue at the same size. Random timeouts keep the unbalanced tree from
+// growing a chain of ever larger keys. The range is the spray, 0 pops the
+// exact minimum.
+template <typename Queue>
+static void BM_POP_MIN(benchmark::State& state) {
+  pinThread(state);
+  const int OPS_PER_THREAD = TOTAL_OPS / state.threads();
+  const int spray = state.range(0);
+  setupSharedTree<Queue>(state, prefill<Queue>);
+  std::mt19937 gen{prefillSeed() + state.thread_index()};
+  std::uniform_int_distribution<int> timeoutDist{1, 2 * QUEUE_ELEMS};
+
+  resetOpCounters(state);
+  for (auto _ : state) {
+    Queue& queue = *sharedTree<Queue>;
+    for (int i = 0; i < OPS_PER_THREAD; i++) {
+      const std::optional<int> key = queue.try_pop_min(spray);
+      if (key) {
+        while (!queue.insert(*key + timeoutDist(gen)))
+          ;
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * OPS_PER_THREAD);
+
+  reportOpCounters(state);
+  teardownSharedTree<Queue>(state);
+}
+
+BENCHMARK(BM_POP_MIN<LockedSet>)
+    ->Arg(0)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_POP_MIN<NatarajanBST<int>>)
+    ->Arg(0)
+    ->Arg(SPRAY)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_POP_MIN<SinghBBST<int>>)
+    ->Arg(0)
+    ->Arg(SPRAY)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "src/CoarseGrainedLockingBST/CGLBST.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+#include "src/SnapshotBST/SnapshotBST.h"
+
+constexpr int SETUP_ELEMS = 65536;
+constexpr int WRITES_PER_THREAD = 16384;
+constexpr int MIN_THREADS = 2;
+constexpr int MAX_THREADS = 32;
+
+template <typename BST>
+void prefill(BST& bst) {
+  prefillBalanced(bst, SETUP_ELEMS);
+}
+
+int countKeys(const CGLBSTNode<int>* node) {
+  return node == nullptr ? 0
+                         : 1 + countKeys(node->left) + countKeys(node->right);
+}
+
+// A consistent scan of CGLBST has to keep every writer out
+int scan(CGLBST<int>& bst) {
+  std::unique_lock<std::shared_mutex> lk{bst.mut};
+  return countKeys(bst.root);
+}
+
+int scan(SnapshotBST<int>& bst) {
+  int count = 0;
+  bst.snapshot().for_each([&count](int) { count++; });
+  return count;
+}
+
+// Thread 0 scans the whole tree while the others insert and remove keys
+template <typename BST>
+static void BM_SCAN_WHILE_WRITING(benchmark::State& state) {
+  pinThread(state);
+  const int tid = state.thread_index();
+  std::vector<int> elems;
+  if (tid != 0)
+    createBalancedInsertion(elems, 0, WRITES_PER_THREAD - 1);
+  setupSharedTree<BST>(state, prefill<BST>);
+
+  int64_t scans = 0, writes = 0;
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    if (tid == 0) {
+      benchmark::DoNotOptimize(scan(bst));
+      scans++;
+      continue;
+    }
+    for (const int elem : elems) {
+      const int key = SETUP_ELEMS + WRITES_PER_THREAD * tid + elem;
+      benchmark::DoNotOptimize(bst.insert(key));
+      benchmark::DoNotOptimize(bst.remove(key));
+    }
+    writes += 2 * elems.size();
+  }
+  state.counters["scans"] =
+      benchmark::Counter(scans, benchmark::Counter::kIsRate);
+  state.counters["writes"] =
+      benchmark::Counter(writes, benchmark::Counter::kIsRate);
+
+  teardownSharedTree<BST>(state);
+}
+
+// Price of keeping versions, against the same algorithm without them
+template <typename BST>
+static void BM_WRITE_ONLY(benchmark::State& state) {
+  pinThread(state);
+  const int tid = state.thread_index();
+  std::vector<int> elems;
+  createBalancedInsertion(elems, 0, WRITES_PER_THREAD - 1);
+  setupSharedTree<BST>(state, prefill<BST>);
+
+  for (auto _ : state) {
+    BST& bst = *sharedTree<BST>;
+    for (const int elem : elems) {
+      const int key = SETUP_ELEMS + WRITES_PER_THREAD * tid + elem;
+      benchmark::DoNotOptimize(bst.insert(key));
+      benchmark::DoNotOptimize(bst.remove(key));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * elems.size());
+
+  teardownSharedTree<BST>(state);
+}
+
+BENCHMARK(BM_SCAN_WHILE_WRITING<CGLBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_SCAN_WHILE_WRITING<SnapshotBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK(BM_WRITE_ONLY<NatarajanBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+BENCHMARK(BM_WRITE_ONLY<SnapshotBST<int>>)
+    ->ThreadRange(MIN_THREADS, MAX_THREADS);
+
+BENCHMARK_MAIN();
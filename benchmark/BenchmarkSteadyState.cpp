@@ -0,0 +1,182 @@
+// Long running mixed workload that samples the tree while it runs, to show
+// how throughput and memory drift over minutes rather than one aggregate.
+// Writes one CSV row per sample:
+//
+//   BenchmarkSteadyState --tree=natarajan --threads=8 --duration=600
+//       --interval=500 --reads=80 --keys=1000000 --out=natarajan.csv
+//
+// Trees: natarajan, singh, cglbst. Pinning, placement and seed come from the
+// same environment variables as the other benchmarks.
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkUtils.h"
+#include "src/CoarseGrainedLockingBST/CGLBST.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+#include "src/SinghBBST/SinghBBST.h"
+
+struct Options {
+  std::string tree = "natarajan";
+  int threads = 4;
+  double duration = 300;
+  int interval = 1000;
+  int reads = 80;
+  int keys = 1 << 20;
+  std::string out;
+};
+
+// Operations finished by one worker, read by the sampler
+struct alignas(64) WorkerCount {
+  std::atomic<uint64_t> ops{0};
+};
+
+// Resident set size from /proc, 0 where it is not available
+uint64_t residentBytes() {
+  std::ifstream statm{"/proc/self/statm"};
+  uint64_t pages = 0, resident = 0;
+  if (!(statm >> pages >> resident))
+    return 0;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Random keys out of [0, keys), reads percent of them looked up and the rest
+// split evenly between inserts and removes, which keeps the tree at about
+// half of the key range
+template <typename BST>
+void work(BST& bst, const Options& options, int tid,
+          const std::atomic<bool>& stop, WorkerCount& count) {
+  pinThread(tid + 1);
+  std::mt19937 rng{prefillSeed() + tid + 1};
+  std::uniform_int_distribution<int> key{0, options.keys - 1}, op{0, 199};
+  uint64_t ops = 0;
+  while (!stop.load(std::memory_order_relaxed)) {
+    // Publish in batches to keep the counter off the hot path
+    for (int i = 0; i < 256; i++, ops++) {
+      const int k = key(rng), o = op(rng);
+      if (o < 2 * options.reads)
+        benchmark::DoNotOptimize(bst[k]);
+      else if (o % 2 == 0)
+        benchmark::DoNotOptimize(bst.insert(k));
+      else
+        benchmark::DoNotOptimize(bst.remove(k));
+    }
+    count.ops.store(ops, std::memory_order_relaxed);
+  }
+}
+
+template <typename BST>
+void run(const Options& options, std::ostream& out) {
+  using Clock = std::chrono::steady_clock;
+  pinThread(0);
+
+  BST* bst;
+  {
+    Numa::ScopedPlacement placement{sharedPlacement()};
+    bst = new BST();
+    std::mt19937 rng{prefillSeed()};
+    std::uniform_int_distribution<int> key{0, options.keys - 1};
+    for (int i = 0; i < options.keys / 2; i++)
+      bst->insert(key(rng));
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<WorkerCount> counts(options.threads);
+  std::vector<std::thread> workers;
+  for (int tid = 0; tid < options.threads; tid++) {
+    workers.emplace_back(work<BST>, std::ref(*bst), std::cref(options), tid,
+                         std::cref(stop), std::ref(counts[tid]));
+  }
+
+  out << "elapsed_ms,ops_per_sec,rss_bytes,height,avg_path_length,"
+         "max_imbalance,deleted_nodes,keys,live_nodes,retired_nodes,"
+         "total_bytes,bytes_per_key\n";
+  const Clock::time_point start = Clock::now();
+  Clock::time_point last = start;
+  uint64_t lastOps = 0;
+  for (Clock::time_point next = start + std::chrono::milliseconds(
+                                            options.interval);
+       next - start <= std::chrono::duration<double>(options.duration);
+       next += std::chrono::milliseconds(options.interval)) {
+    std::this_thread::sleep_until(next);
+    const Clock::time_point now = Clock::now();
+    uint64_t ops = 0;
+    for (const WorkerCount& count : counts)
+      ops += count.ops.load(std::memory_order_relaxed);
+    const double seconds = std::chrono::duration<double>(now - last).count();
+
+    // Walks the tree while the workers keep going, so the shape is
+    // approximate. CGLBST holds its lock shared for the walk.
+    const ShapeStats shape = bst->shape_stats();
+    const MemoryStats stats = bst->memory_stats();
+    out << std::chrono::duration_cast<std::chrono::milliseconds>(now - start)
+               .count()
+        << ',' << static_cast<uint64_t>((ops - lastOps) / seconds) << ','
+        << residentBytes() << ',' << shape.height << ','
+        << shape.averagePathLength() << ',' << shape.maxImbalance << ','
+        << shape.deletedNodes << ',' << stats.keys << ',' << stats.liveNodes
+        << ',' << stats.retiredNodes << ',' << stats.totalBytes() << ','
+        << stats.bytesPerKey() << std::endl;
+    last = now;
+    lastOps = ops;
+  }
+
+  stop.store(true);
+  for (std::thread& worker : workers)
+    worker.join();
+  delete bst;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const std::size_t eq = arg.find('=');
+    const std::string name = arg.substr(0, eq),
+                      value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (name == "--tree")
+      options.tree = value;
+    else if (name == "--threads")
+      options.threads = std::stoi(value);
+    else if (name == "--duration")
+      options.duration = std::stod(value);
+    else if (name == "--interval")
+      options.interval = std::stoi(value);
+    else if (name == "--reads")
+      options.reads = std::stoi(value);
+    else if (name == "--keys")
+      options.keys = std::stoi(value);
+    else if (name == "--out")
+      options.out = value;
+    else {
+      std::cerr << "unknown option " << arg << '\n';
+      return 1;
+    }
+  }
+
+  std::ofstream file;
+  if (!options.out.empty())
+    file.open(options.out);
+  std::ostream& out = options.out.empty() ? std::cout : file;
+
+  if (options.tree == "natarajan")
+    run<NatarajanBST<int>>(options, out);
+  else if (options.tree == "singh")
+    run<SinghBBST<int>>(options, out);
+  else if (options.tree == "cglbst")
+    run<CGLBST<int>>(options, out);
+  else {
+    std::cerr << "unknown tree " << options.tree << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "src/Common/LockProfiler.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/NumaAllocator.h"
+#include "src/Common/OpCounters.h"
+#include "src/Common/ShapeStats.h"
+
+// CPUs in the order benchmark threads are pinned to them. "compact" fills
+// one NUMA node before moving to the next, "scatter" deals consecutive
+// threads out to the nodes in turn, both over the CPUs the process may run
+// on, as a cpuset limits them. A comma separated list of CPUs is taken as
+// is. Empty if threads are not pinned.
+inline std::vector<int> pinningOrder(const std::string& mode) {
+  std::vector<int> order;
+  if (!mode.empty() && std::isdigit(static_cast<unsigned char>(mode[0]))) {
+    std::size_t pos = 0;
+    while (pos < mode.size()) {
+      std::size_t end = mode.find(',', pos);
+      if (end == std::string::npos)
+        end = mode.size();
+      order.push_back(std::stoi(mode.substr(pos, end - pos)));
+      pos = end + 1;
+    }
+    return order;
+  }
+
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    std::cerr << "sched_getaffinity: " << std::strerror(errno) << '\n';
+    std::abort();
+  }
+  const std::size_t cpus = CPU_COUNT(&allowed);
+  std::vector<std::vector<int>> byNode(Numa::nodeCount());
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed))
+      byNode[Numa::nodeOfCpu(cpu)].push_back(cpu);
+  }
+
+  if (mode == "compact") {
+    for (const std::vector<int>& node : byNode)
+      order.insert(order.end(), node.begin(), node.end());
+  } else if (mode == "scatter") {
+    for (std::size_t i = 0; order.size() < cpus; i++) {
+      for (const std::vector<int>& node : byNode) {
+        if (i < node.size())
+          order.push_back(node[i]);
+      }
+    }
+  }
+  return order;
+}
+
+// Pins the calling thread, the index-th of the run, as the BENCHMARK_PINNING
+// environment variable asks, compact, scatter or a list of CPUs. Call it
+// before the thread builds any part of the tree, nodes are placed on the NUMA
+// node of their allocator. Aborts if the CPU is not one the thread may run
+// on, results would be reported for a placement they did not have.
+inline void pinThread(int index) {
+  static const std::vector<int> order = [] {
+    const char* mode = std::getenv("BENCHMARK_PINNING");
+    return pinningOrder(mode == nullptr ? "" : mode);
+  }();
+  if (order.empty())
+    return;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  const int cpu = order[index % order.size()];
+  CPU_SET(cpu, &set);
+  if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(set),
+                                               &set)) {
+    std::cerr << "pinning thread " << index << " to CPU " << cpu << ": "
+              << std::strerror(error) << '\n';
+    std::abort();
+  }
+}
+
+inline void pinThread(benchmark::State& state) {
+  pinThread(state.thread_index());
+}
+
+// Seed of every randomised prefill, BENCHMARK_SEED or 42, so that runs being
+// compared build the same trees
+inline unsigned prefillSeed() {
+  static const unsigned seed = [] {
+    const char* seed = std::getenv("BENCHMARK_SEED");
+    return seed == nullptr ? 42u : static_cast<unsigned>(std::stoul(seed));
+  }();
+  return seed;
+}
+
+// Keys start to end in the order that builds a balanced tree without any
+// rebalancing, every key ahead of the ones below and above it
+inline void createBalancedInsertion(std::vector<int>& container, int start,
+                                    int end) {
+  if (start > end)
+    return;
+  int mid = start + (end - start) / 2;
+  container.push_back(mid);
+  createBalancedInsertion(container, start, mid - 1);
+  createBalancedInsertion(container, mid + 1, end);
+}
+
+// Inserts stride times the keys 0 to size - 1 in balanced order. Sets that
+// copy on every update take all keys at once.
+template <typename BST>
+void prefillBalanced(BST& bst, int size, int stride = 1) {
+  std::vector<int> keys;
+  createBalancedInsertion(keys, 0, size - 1);
+  for (int& key : keys)
+    key *= stride;
+  if constexpr (requires { bst.insert_all(keys.begin(), keys.end()); }) {
+    bst.insert_all(keys.begin(), keys.end());
+    return;
+  }
+  for (const int key : keys)
+    bst.insert(key);
+}
+
+// Placement of trees built by a single thread and shared by all, from the
+// BENCHMARK_PLACEMENT environment variable. "interleave" spreads them over
+// every NUMA node, anything else keeps them local to the building thread.
+inline Numa::Placement sharedPlacement() {
+  const char* placement = std::getenv("BENCHMARK_PLACEMENT");
+  return placement != nullptr && std::string{placement} == "interleave"
+             ? Numa::Placement::INTERLEAVE
+             : Numa::Placement::LOCAL;
+}
+
+// Bytes the tree holds per key, including nodes it unlinked but never freed.
+// Call it from a single thread once the timed loop is over.
+template <typename BST>
+void reportMemory(benchmark::State& state, BST& bst) {
+  const MemoryStats stats = bst.memory_stats();
+  state.counters["bytes_per_key"] = stats.bytesPerKey();
+}
+
+// Shape of the tree once the timed loop is over, for trees that report one
+template <typename BST>
+void reportShape(benchmark::State& state, BST& bst) {
+  if constexpr (requires { bst.shape_stats(); }) {
+    if (state.thread_index() != 0)
+      return;
+    const ShapeStats shape = bst.shape_stats();
+    state.counters["height"] = shape.height;
+    state.counters["avg_path_length"] = shape.averagePathLength();
+    state.counters["max_imbalance"] = shape.maxImbalance;
+    state.counters["deleted_nodes"] = shape.deletedNodes;
+  }
+}
+
+// One tree shared by all threads of a run, created and destroyed by thread 0.
+// Threads only touch it inside the loop, which starts and ends on a barrier.
+template <typename BST>
+BST* sharedTree = nullptr;
+
+// Thread 0 builds the tree and hands it to prefill, the others wait for it at
+// the start of the loop
+template <typename BST, typename Prefill>
+void setupSharedTree(benchmark::State& state, Prefill&& prefill) {
+  if (state.thread_index() != 0)
+    return;
+  Numa::ScopedPlacement placement{sharedPlacement()};
+  sharedTree<BST> = new BST();
+  prefill(*sharedTree<BST>);
+}
+
+template <typename BST>
+void teardownSharedTree(benchmark::State& state) {
+  if (state.thread_index() != 0)
+    return;
+  reportMemory(state, *sharedTree<BST>);
+  delete sharedTree<BST>;
+  sharedTree<BST> = nullptr;
+}
+
+// Hot path counters of the lock-free trees, empty unless built with
+// WITH_OP_COUNTERS. Thread 0 resets them right before the timed loop and
+// reports the totals of every thread after it.
+inline void resetOpCounters(benchmark::State& state) {
+  if (state.thread_index() == 0)
+    OpCounters::reset();
+}
+
+inline void reportOpCounters(benchmark::State& state) {
+  if (!OpCounters::ENABLED || state.thread_index() != 0)
+    return;
+  const OpCounters::Totals totals = OpCounters::collect();
+  for (int c = 0; c < OpCounters::NUM_COUNTERS; c++)
+    state.counters[OpCounters::NAMES[c]] = totals[c];
+  if (totals[OpCounters::SEEK] != 0)
+    state.counters["avg_depth"] =
+        static_cast<double>(totals[OpCounters::SEEK_DEPTH]) /
+        totals[OpCounters::SEEK];
+}
+
+// Benchmark name out of the __PRETTY_FUNCTION__ of a benchmark template, so
+// that it also works with Google Benchmark releases without State::name()
+inline std::string benchmarkName(benchmark::State& state,
+                                 const std::string& function) {
+  const std::size_t open = function.find('(');
+  const std::size_t begin = function.rfind(' ', open) + 1;
+  std::string name = function.substr(begin, open - begin);
+  const std::size_t with = function.find("= ", open);
+  if (with != std::string::npos)
+    name += '<' + function.substr(with + 2, function.rfind(']') - with - 2) +
+            '>';
+  return name + "/threads:" + std::to_string(state.threads());
+}
+
+// Lock profile of the lock-based trees, empty unless built with
+// WITH_LOCK_PROFILING. The latest run of every benchmark is kept and printed
+// as one table per benchmark when the binary exits. Pass
+// __PRETTY_FUNCTION__ as the function.
+inline void resetLockProfile(benchmark::State& state) {
+  if (state.thread_index() == 0)
+    LockProfiler::reset();
+}
+
+inline void reportLockProfile(benchmark::State& state, const char* function) {
+  if (!LockProfiler::ENABLED || state.thread_index() != 0)
+    return;
+
+  struct Summary {
+    std::map<std::string, LockProfiler::Profile> runs;
+    ~Summary() {
+      for (const auto& [name, profile] : runs) {
+        uint64_t totalWait = 0;
+        for (const LockProfiler::LevelStats& stats : profile)
+          totalWait += stats.waitNs;
+        std::cout << '\n'
+                  << name << '\n'
+                  << std::setw(12) << "depth" << std::setw(16)
+                  << "acquisitions" << std::setw(14) << "wait ns/acq"
+                  << std::setw(14) << "hold ns/acq" << std::setw(12)
+                  << "wait share" << '\n';
+        for (int l = 0; l < LockProfiler::NUM_LEVELS; l++) {
+          const LockProfiler::LevelStats& stats = profile[l];
+          if (stats.acquisitions == 0)
+            continue;
+          const uint64_t low = l == 0 ? 0 : uint64_t{1} << (l - 1);
+          const std::string depth =
+              l <= 1 ? std::to_string(low)
+              : l == LockProfiler::NUM_LEVELS - 1
+                  ? std::to_string(low) + "+"
+                  : std::to_string(low) + "-" + std::to_string(2 * low - 1);
+          std::cout << std::setw(12) << depth << std::setw(16)
+                    << stats.acquisitions << std::fixed
+                    << std::setprecision(1) << std::setw(14)
+                    << static_cast<double>(stats.waitNs) / stats.acquisitions
+                    << std::setw(14)
+                    << static_cast<double>(stats.holdNs) / stats.acquisitions
+                    << std::setw(11)
+                    << (totalWait == 0 ? 0.0 : 100.0 * stats.waitNs / totalWait)
+                    << "%\n";
+        }
+      }
+    }
+  };
+  static Summary summary;
+
+  const LockProfiler::Profile profile = LockProfiler::collect();
+  LockProfiler::LevelStats total;
+  for (const LockProfiler::LevelStats& stats : profile) {
+    total.acquisitions += stats.acquisitions;
+    total.waitNs += stats.waitNs;
+    total.holdNs += stats.holdNs;
+  }
+  if (total.acquisitions == 0)
+    return;
+  summary.runs[benchmarkName(state, function)] = profile;
+  state.counters["lock_acquisitions"] = total.acquisitions;
+  state.counters["lock_wait_ns"] =
+      static_cast<double>(total.waitNs) / total.acquisitions;
+  state.counters["lock_hold_ns"] =
+      static_cast<double>(total.holdNs) / total.acquisitions;
+}
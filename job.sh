@@ -8,5 +8,7 @@
 
 cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
 cmake --build build --target all -j 6
-export BENCHMARK_BUILD="build/BenchmarkBSTImbalanced"
-./${BENCHMARK_BUILD}
\ No newline at end of file
+python3 tools/run_benchmarks.py --build build \
+    --benchmarks BenchmarkBST,BenchmarkBSTImbalanced \
+    --pinning compact,scatter --repetitions 5 --warmup 0.5 --seed 42 \
+    --out benchmark/benchmark_results.json --csv benchmark/benchmark_results.csv
\ No newline at end of file
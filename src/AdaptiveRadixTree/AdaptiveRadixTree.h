@@ -0,0 +1,333 @@
+#pragma once
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "Node.h"
+#include "src/Common/MemoryStats.h"
+
+// Adaptive radix tree over the big-endian bytes of an integer key, with
+// optimistic lock coupling, lazy expansion and path compression. Keys
+// narrower than a pointer live in the child slot itself, wider keys in a
+// separately allocated leaf. Nodes only ever grow. Replaced nodes and removed
+// leaves may still be read by concurrent operations, so they are retired and
+// freed together with the tree.
+template <class T>
+struct AdaptiveRadixTree {
+  static_assert(std::is_integral_v<T> && sizeof(T) <= ART::MAX_PREFIX,
+                "Keys must be integers of at most 8 bytes");
+
+  using U = std::make_unsigned_t<T>;
+  using KeyBytes = std::array<uint8_t, sizeof(T)>;
+  constexpr static uint32_t KEY_LEN = sizeof(T);
+  constexpr static bool EMBEDDED_LEAVES = sizeof(T) < sizeof(ART::Child);
+
+  ART::Node* const root = new ART::N256();
+
+  ~AdaptiveRadixTree() {
+    cleanup_all(root);
+    for (ART::Node* node : retiredNodes)
+      node->destroy();
+    for (T* leaf : retiredLeaves)
+      delete leaf;
+  }
+
+  bool operator[](const T& key) {
+    const KeyBytes bytes = toBytes(key);
+
+  restart:
+    ART::Node* node = root;
+    uint64_t version;
+    if (!node->lock.readLock(version))
+      goto restart;
+
+    for (uint32_t level = 0;; level++) {
+      uint32_t prefixLen = node->prefixLen;
+      if (level + prefixLen >= KEY_LEN)
+        goto restart;
+      if (prefixMismatch(node, prefixLen, bytes, level) != prefixLen) {
+        if (!node->lock.validate(version))
+          goto restart;
+        return false;
+      }
+      level += prefixLen;
+
+      ART::Child child = node->getChild(bytes[level]);
+      if (!node->lock.validate(version))
+        goto restart;
+      if (child == ART::EMPTY)
+        return false;
+      if (ART::isLeaf(child))
+        return leafKey(child) == key;
+
+      node = reinterpret_cast<ART::Node*>(child);
+      if (!node->lock.readLock(version))
+        goto restart;
+    }
+  }
+
+  bool insert(const T& key) {
+    const KeyBytes bytes = toBytes(key);
+
+  restart:
+    ART::Node *node = nullptr, *next = root, *parent = nullptr;
+    uint8_t nodeByte = 0, parentByte = 0;
+    uint64_t version = 0, parentVersion = 0;
+
+    for (uint32_t level = 0;; level++) {
+      parent = node;
+      parentByte = nodeByte;
+      parentVersion = version;
+      node = next;
+      if (!node->lock.readLock(version))
+        goto restart;
+
+      uint32_t prefixLen = node->prefixLen;
+      if (level + prefixLen >= KEY_LEN)
+        goto restart;
+      uint32_t mismatch = prefixMismatch(node, prefixLen, bytes, level);
+      if (mismatch != prefixLen) {
+        // The key leaves the compressed path, split it with a new N4. The
+        // root has no prefix, so there always is a parent here.
+        if (!parent->lock.upgrade(parentVersion))
+          goto restart;
+        if (!node->lock.upgrade(version)) {
+          parent->lock.writeUnlock();
+          goto restart;
+        }
+
+        auto* split = new ART::N4();
+        split->setPrefix(node->prefix, mismatch);
+        split->insert(node->prefix[mismatch], toChild(node));
+        split->insert(bytes[level + mismatch], makeLeaf(key));
+        std::memmove(node->prefix, node->prefix + mismatch + 1,
+                     prefixLen - mismatch - 1);
+        node->prefixLen = prefixLen - mismatch - 1;
+        parent->change(parentByte, toChild(split));
+
+        node->lock.writeUnlock();
+        parent->lock.writeUnlock();
+        return true;
+      }
+      level += prefixLen;
+
+      nodeByte = bytes[level];
+      ART::Child child = node->getChild(nodeByte);
+      if (!node->lock.validate(version))
+        goto restart;
+
+      if (child == ART::EMPTY) {
+        // Upgrading validates that isFull was read from a consistent node
+        if (!node->isFull()) {
+          if (!node->lock.upgrade(version))
+            goto restart;
+          node->insert(nodeByte, makeLeaf(key));
+          node->lock.writeUnlock();
+          return true;
+        }
+
+        // The root is an N256 and never full, so there is a parent
+        if (!parent->lock.upgrade(parentVersion))
+          goto restart;
+        if (!node->lock.upgrade(version)) {
+          parent->lock.writeUnlock();
+          goto restart;
+        }
+        ART::Node* bigger = node->grow();
+        bigger->insert(nodeByte, makeLeaf(key));
+        parent->change(parentByte, toChild(bigger));
+
+        node->lock.writeUnlockObsolete();
+        parent->lock.writeUnlock();
+        retire(node);
+        return true;
+      }
+
+      if (ART::isLeaf(child)) {
+        const T existing = leafKey(child);
+        if (existing == key)
+          return false;
+        if (!node->lock.upgrade(version))
+          goto restart;
+
+        // Lazy expansion, both keys share the path up to this level
+        const KeyBytes existingBytes = toBytes(existing);
+        uint32_t common = 0;
+        while (existingBytes[level + 1 + common] == bytes[level + 1 + common])
+          common++;
+        auto* expanded = new ART::N4();
+        expanded->setPrefix(bytes.data() + level + 1, common);
+        expanded->insert(existingBytes[level + 1 + common], child);
+        expanded->insert(bytes[level + 1 + common], makeLeaf(key));
+        node->change(nodeByte, toChild(expanded));
+
+        node->lock.writeUnlock();
+        return true;
+      }
+
+      next = reinterpret_cast<ART::Node*>(child);
+    }
+  }
+
+  bool remove(const T& key) {
+    const KeyBytes bytes = toBytes(key);
+
+  restart:
+    ART::Node* node = root;
+    uint64_t version;
+    if (!node->lock.readLock(version))
+      goto restart;
+
+    for (uint32_t level = 0;; level++) {
+      uint32_t prefixLen = node->prefixLen;
+      if (level + prefixLen >= KEY_LEN)
+        goto restart;
+      if (prefixMismatch(node, prefixLen, bytes, level) != prefixLen) {
+        if (!node->lock.validate(version))
+          goto restart;
+        return false;
+      }
+      level += prefixLen;
+
+      const uint8_t byte = bytes[level];
+      ART::Child child = node->getChild(byte);
+      if (!node->lock.validate(version))
+        goto restart;
+      if (child == ART::EMPTY)
+        return false;
+
+      if (ART::isLeaf(child)) {
+        if (leafKey(child) != key)
+          return false;
+        if (!node->lock.upgrade(version))
+          goto restart;
+        // Nodes are not shrunk or merged, an empty node simply stays
+        node->remove(byte);
+        node->lock.writeUnlock();
+        retireLeaf(child);
+        return true;
+      }
+
+      node = reinterpret_cast<ART::Node*>(child);
+      if (!node->lock.readLock(version))
+        goto restart;
+    }
+  }
+
+  // Replaced nodes and removed leaves stay retired until the tree is destroyed.
+  // Each node is read under its lock version and read again if a writer
+  // changed it meanwhile, the walk restarts if one was replaced.
+  MemoryStats memory_stats() {
+    MemoryStats stats;
+    std::vector<ART::Node*> stack, children;
+  restart:
+    stats = MemoryStats{};
+    stack.assign(1, root);
+    while (!stack.empty()) {
+      ART::Node* node = stack.back();
+      uint64_t version;
+      if (!node->lock.readLock(version))
+        goto restart;
+      std::size_t leaves = 0;
+      children.clear();
+      node->forEachChild([&](uint8_t, ART::Child child) {
+        if (ART::isLeaf(child))
+          leaves++;
+        else
+          children.push_back(reinterpret_cast<ART::Node*>(child));
+      });
+      if (!node->lock.validate(version))
+        continue;
+      stack.pop_back();
+      stack.insert(stack.end(), children.begin(), children.end());
+      stats.liveNodes++;
+      stats.liveBytes += ART::nodeBytes(node);
+      stats.keys += leaves;
+      if constexpr (!EMBEDDED_LEAVES) {
+        stats.liveNodes += leaves;
+        stats.liveBytes += leaves * sizeof(T);
+      }
+    }
+
+    std::lock_guard lk{retiredMut};
+    for (ART::Node* node : retiredNodes)
+      stats.retiredBytes += ART::nodeBytes(node);
+    stats.retiredNodes = retiredNodes.size() + retiredLeaves.size();
+    stats.retiredBytes += retiredLeaves.size() * sizeof(T);
+    return stats;
+  }
+
+ private:
+  std::mutex retiredMut{};
+  std::vector<ART::Node*> retiredNodes;
+  std::vector<T*> retiredLeaves;
+
+  // Order preserving: flip the sign bit and store the most significant byte
+  // first
+  static KeyBytes toBytes(const T& key) {
+    U bits = static_cast<U>(key);
+    if constexpr (std::is_signed_v<T>)
+      bits ^= U(1) << (CHAR_BIT * KEY_LEN - 1);
+
+    KeyBytes bytes;
+    for (uint32_t i = 0; i < KEY_LEN; i++)
+      bytes[i] = static_cast<uint8_t>(bits >> (CHAR_BIT * (KEY_LEN - 1 - i)));
+    return bytes;
+  }
+
+  // Index of the first prefix byte that differs from the key
+  static uint32_t prefixMismatch(const ART::Node* node, uint32_t prefixLen,
+                                 const KeyBytes& bytes, uint32_t level) {
+    for (uint32_t i = 0; i < prefixLen; i++) {
+      if (node->prefix[i] != bytes[level + i])
+        return i;
+    }
+    return prefixLen;
+  }
+
+  static ART::Child toChild(ART::Node* node) {
+    return reinterpret_cast<ART::Child>(node);
+  }
+
+  static ART::Child makeLeaf(const T& key) {
+    if constexpr (EMBEDDED_LEAVES)
+      return (static_cast<ART::Child>(static_cast<U>(key)) << 1) |
+             ART::LEAF_TAG;
+    else
+      return reinterpret_cast<ART::Child>(new T(key)) | ART::LEAF_TAG;
+  }
+
+  static T leafKey(ART::Child leaf) {
+    if constexpr (EMBEDDED_LEAVES)
+      return static_cast<T>(static_cast<U>(leaf >> 1));
+    else
+      return *reinterpret_cast<const T*>(leaf & ~ART::LEAF_TAG);
+  }
+
+  void retire(ART::Node* node) {
+    std::lock_guard lk{retiredMut};
+    retiredNodes.push_back(node);
+  }
+
+  void retireLeaf(ART::Child leaf) {
+    if constexpr (!EMBEDDED_LEAVES) {
+      std::lock_guard lk{retiredMut};
+      retiredLeaves.push_back(reinterpret_cast<T*>(leaf & ~ART::LEAF_TAG));
+    }
+  }
+
+  void cleanup_all(ART::Node* node) {
+    node->forEachChild([this](uint8_t, ART::Child child) {
+      if (!ART::isLeaf(child))
+        cleanup_all(reinterpret_cast<ART::Node*>(child));
+      else if constexpr (!EMBEDDED_LEAVES)
+        delete reinterpret_cast<T*>(child & ~ART::LEAF_TAG);
+    });
+    node->destroy();
+  }
+};
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "src/Common/NumaAllocator.h"
+
+namespace ART {
+// Child slots hold either an inner node or a leaf, leaves have the low bit set
+using Child = uintptr_t;
+constexpr Child LEAF_TAG = 1;
+constexpr Child EMPTY = 0;
+
+inline bool isLeaf(Child child) {
+  return (child & LEAF_TAG) != 0;
+}
+
+// Version lock as in the OLC ART paper. Bit 0 marks a node that has been
+// replaced, bit 1 is the write lock.
+struct OptimisticLock {
+  constexpr static uint64_t OBSOLETE = 1, LOCKED = 2;
+
+  std::atomic<uint64_t> version{4};
+
+  // Returns false if the node has been replaced and the caller must restart
+  bool readLock(uint64_t& v) const {
+    v = version.load(std::memory_order_acquire);
+    while (v & LOCKED) {
+      std::this_thread::yield();
+      v = version.load(std::memory_order_acquire);
+    }
+    return (v & OBSOLETE) == 0;
+  }
+
+  bool validate(uint64_t v) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version.load(std::memory_order_relaxed) == v;
+  }
+
+  bool upgrade(uint64_t v) {
+    return version.compare_exchange_strong(v, v + LOCKED,
+                                           std::memory_order_acquire);
+  }
+
+  void writeUnlock() { version.fetch_add(LOCKED, std::memory_order_release); }
+
+  void writeUnlockObsolete() {
+    version.fetch_add(LOCKED + OBSOLETE, std::memory_order_release);
+  }
+};
+
+enum class NodeType : uint8_t { N4, N16, N48, N256 };
+
+constexpr uint32_t MAX_PREFIX = 8;  // keys are at most 8 bytes
+
+struct Node : Numa::Allocated {
+  OptimisticLock lock;
+  const NodeType type;
+  uint8_t prefixLen{0};
+  uint16_t count{0};
+  uint8_t prefix[MAX_PREFIX]{};
+
+  explicit Node(NodeType type) : type{type} {}
+
+  void setPrefix(const uint8_t* bytes, uint32_t len) {
+    std::memcpy(prefix, bytes, len);
+    prefixLen = len;
+  }
+
+  inline Child getChild(uint8_t byte) const;
+  inline bool isFull() const;
+  // Assumes the byte is absent and the node is not full
+  inline void insert(uint8_t byte, Child child);
+  inline void change(uint8_t byte, Child child);
+  inline void remove(uint8_t byte);
+  // Copy of this node with room for at least one more child
+  inline Node* grow() const;
+  template <class F>
+  void forEachChild(F&& f) const;
+  inline void destroy();
+};
+
+// N4 and N16 keep their bytes sorted
+template <NodeType TYPE, int CAPACITY>
+struct SmallNode : Node {
+  uint8_t keys[CAPACITY]{};
+  Child children[CAPACITY]{};
+
+  SmallNode() : Node(TYPE) {}
+
+  int size() const { return std::min<int>(count, CAPACITY); }
+
+  Child getChild(uint8_t byte) const {
+    for (int i = 0, n = size(); i < n; i++) {
+      if (keys[i] == byte)
+        return children[i];
+    }
+    return EMPTY;
+  }
+
+  void insert(uint8_t byte, Child child) {
+    int pos = 0;
+    while (pos < count && keys[pos] < byte)
+      pos++;
+    std::copy_backward(keys + pos, keys + count, keys + count + 1);
+    std::copy_backward(children + pos, children + count, children + count + 1);
+    keys[pos] = byte;
+    children[pos] = child;
+    count++;
+  }
+
+  void change(uint8_t byte, Child child) {
+    for (int i = 0; i < count; i++) {
+      if (keys[i] == byte)
+        children[i] = child;
+    }
+  }
+
+  void remove(uint8_t byte) {
+    for (int i = 0; i < count; i++) {
+      if (keys[i] == byte) {
+        std::copy(keys + i + 1, keys + count, keys + i);
+        std::copy(children + i + 1, children + count, children + i);
+        count--;
+        return;
+      }
+    }
+  }
+
+  template <class F>
+  void forEach(F&& f) const {
+    for (int i = 0, n = size(); i < n; i++)
+      f(keys[i], children[i]);
+  }
+
+  template <class Bigger>
+  void copyTo(Bigger* node) const {
+    for (int i = 0; i < count; i++)
+      node->insert(keys[i], children[i]);
+    node->setPrefix(prefix, prefixLen);
+  }
+};
+
+using N4 = SmallNode<NodeType::N4, 4>;
+using N16 = SmallNode<NodeType::N16, 16>;
+
+struct N48 : Node {
+  constexpr static int CAPACITY = 48;
+  constexpr static uint8_t NO_CHILD = CAPACITY;
+
+  uint8_t childIndex[256];
+  Child children[CAPACITY]{};
+
+  N48() : Node(NodeType::N48) { std::fill_n(childIndex, 256, NO_CHILD); }
+
+  Child getChild(uint8_t byte) const {
+    uint8_t idx = childIndex[byte];
+    return idx == NO_CHILD ? EMPTY : children[idx];
+  }
+
+  void insert(uint8_t byte, Child child) {
+    int pos = count;
+    if (children[pos] != EMPTY) {
+      // Slots freed by remove leave holes
+      for (pos = 0; children[pos] != EMPTY; pos++)
+        ;
+    }
+    children[pos] = child;
+    childIndex[byte] = static_cast<uint8_t>(pos);
+    count++;
+  }
+
+  void change(uint8_t byte, Child child) { children[childIndex[byte]] = child; }
+
+  void remove(uint8_t byte) {
+    children[childIndex[byte]] = EMPTY;
+    childIndex[byte] = NO_CHILD;
+    count--;
+  }
+
+  template <class F>
+  void forEach(F&& f) const {
+    for (int byte = 0; byte < 256; byte++) {
+      if (childIndex[byte] != NO_CHILD)
+        f(static_cast<uint8_t>(byte), children[childIndex[byte]]);
+    }
+  }
+
+  template <class Bigger>
+  void copyTo(Bigger* node) const {
+    forEach([node](uint8_t byte, Child child) { node->insert(byte, child); });
+    node->setPrefix(prefix, prefixLen);
+  }
+};
+
+struct N256 : Node {
+  Child children[256]{};
+
+  N256() : Node(NodeType::N256) {}
+
+  Child getChild(uint8_t byte) const { return children[byte]; }
+
+  void insert(uint8_t byte, Child child) {
+    children[byte] = child;
+    count++;
+  }
+
+  void change(uint8_t byte, Child child) { children[byte] = child; }
+
+  void remove(uint8_t byte) {
+    children[byte] = EMPTY;
+    count--;
+  }
+
+  template <class F>
+  void forEach(F&& f) const {
+    for (int byte = 0; byte < 256; byte++) {
+      if (children[byte] != EMPTY)
+        f(static_cast<uint8_t>(byte), children[byte]);
+    }
+  }
+};
+
+#define ART_DISPATCH(node, call)                  \
+  switch ((node)->type) {                         \
+    case NodeType::N4:                            \
+      return static_cast<N4*>(node)->call;        \
+    case NodeType::N16:                           \
+      return static_cast<N16*>(node)->call;       \
+    case NodeType::N48:                           \
+      return static_cast<N48*>(node)->call;       \
+    default:                                      \
+      return static_cast<N256*>(node)->call;      \
+  }
+
+#define ART_CONST_DISPATCH(node, call)               \
+  switch ((node)->type) {                            \
+    case NodeType::N4:                               \
+      return static_cast<const N4*>(node)->call;     \
+    case NodeType::N16:                              \
+      return static_cast<const N16*>(node)->call;    \
+    case NodeType::N48:                              \
+      return static_cast<const N48*>(node)->call;    \
+    default:                                         \
+      return static_cast<const N256*>(node)->call;   \
+  }
+
+Child Node::getChild(uint8_t byte) const {
+  ART_CONST_DISPATCH(this, getChild(byte))
+}
+
+bool Node::isFull() const {
+  switch (type) {
+    case NodeType::N4:
+      return count == 4;
+    case NodeType::N16:
+      return count == 16;
+    case NodeType::N48:
+      return count == N48::CAPACITY;
+    default:
+      return false;
+  }
+}
+
+void Node::insert(uint8_t byte, Child child) {
+  ART_DISPATCH(this, insert(byte, child))
+}
+
+void Node::change(uint8_t byte, Child child) {
+  ART_DISPATCH(this, change(byte, child))
+}
+
+void Node::remove(uint8_t byte) {
+  ART_DISPATCH(this, remove(byte))
+}
+
+Node* Node::grow() const {
+  Node* bigger = nullptr;
+  switch (type) {
+    case NodeType::N4:
+      bigger = new N16();
+      static_cast<const N4*>(this)->copyTo(static_cast<N16*>(bigger));
+      break;
+    case NodeType::N16:
+      bigger = new N48();
+      static_cast<const N16*>(this)->copyTo(static_cast<N48*>(bigger));
+      break;
+    default:
+      bigger = new N256();
+      static_cast<const N48*>(this)->copyTo(static_cast<N256*>(bigger));
+  }
+  return bigger;
+}
+
+template <class F>
+void Node::forEachChild(F&& f) const {
+  ART_CONST_DISPATCH(this, forEach(f))
+}
+
+void Node::destroy() {
+  switch (type) {
+    case NodeType::N4:
+      delete static_cast<N4*>(this);
+      break;
+    case NodeType::N16:
+      delete static_cast<N16*>(this);
+      break;
+    case NodeType::N48:
+      delete static_cast<N48*>(this);
+      break;
+    default:
+      delete static_cast<N256*>(this);
+  }
+}
+
+inline std::size_t nodeBytes(const Node* node) {
+  switch (node->type) {
+    case NodeType::N4:
+      return sizeof(N4);
+    case NodeType::N16:
+      return sizeof(N16);
+    case NodeType::N48:
+      return sizeof(N48);
+    default:
+      return sizeof(N256);
+  }
+}
+
+#undef ART_DISPATCH
+#undef ART_CONST_DISPATCH
+}  // namespace ART
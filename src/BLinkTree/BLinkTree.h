@@ -0,0 +1,212 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "Node.h"
+#include "OptimisticLock.h"
+#include "src/Common/MemoryStats.h"
+
+// B+-tree with B-link right pointers and optimistic lock coupling. Nodes are
+// never merged, so a node that has been reached stays valid and a split only
+// ever moves keys to the right sibling, which readers follow instead of
+// restarting from the root.
+template <class T, std::size_t NODE_SIZE = 4 * BLink::CACHE_LINE_SIZE>
+struct BLinkTree {
+  using Base = BLink::NodeBase<T>;
+  using Leaf = BLink::LeafNode<T, NODE_SIZE>;
+  using Inner = BLink::InnerNode<T, NODE_SIZE>;
+
+  std::atomic<Base*> root{new Leaf()};
+
+  ~BLinkTree() { cleanup_all(root.load()); }
+
+  bool operator[](const T& key) {
+    while (true) {
+      uint64_t version;
+      Leaf* leaf = findLeaf(key, version);
+      bool found = leaf->contains(key);
+      if (leaf->lock.validate(version))
+        return found;
+    }
+  }
+
+  bool insert(const T& key) {
+    while (true) {
+      uint64_t version;
+      Leaf* leaf = findLeaf(key, version);
+      bool found = leaf->contains(key), full = leaf->isFull();
+      if (!leaf->lock.validate(version))
+        continue;
+      if (found)
+        return false;
+
+      if (full) {
+        splitPath(key);
+        continue;
+      }
+
+      if (!leaf->lock.upgrade(version))
+        continue;
+      leaf->insert(key);
+      leaf->lock.writeUnlock();
+      return true;
+    }
+  }
+
+  bool remove(const T& key) {
+    while (true) {
+      uint64_t version;
+      Leaf* leaf = findLeaf(key, version);
+      bool found = leaf->contains(key);
+      if (!leaf->lock.validate(version))
+        continue;
+      if (!found)
+        return false;
+
+      if (!leaf->lock.upgrade(version))
+        continue;
+      leaf->remove(key);
+      leaf->lock.writeUnlock();
+      return true;
+    }
+  }
+
+  // Walks every level along its right links, nodes are never freed early.
+  // Each node is read under its lock version and read again if a writer
+  // changed it meanwhile.
+  MemoryStats memory_stats() {
+    MemoryStats stats;
+    for (Base* level = root.load(); level != nullptr;) {
+      Base* below = nullptr;
+      for (Base* node = level; node != nullptr;) {
+        const uint64_t version = node->lock.readLock();
+        const std::size_t count = node->count;
+        Base* next = node->next;
+        if (node == level && !node->isLeaf)
+          below = static_cast<Inner*>(node)->children[0];
+        if (!node->lock.validate(version))
+          continue;
+        stats.liveNodes++;
+        if (node->isLeaf) {
+          stats.keys += count;
+          stats.liveBytes += sizeof(Leaf);
+        } else {
+          stats.liveBytes += sizeof(Inner);
+        }
+        node = next;
+      }
+      level = below;
+    }
+    return stats;
+  }
+
+ private:
+  // Returns the leaf responsible for key, version must still be validated
+  Leaf* findLeaf(const T& key, uint64_t& version) {
+  restart:
+    Base* node = root.load();
+    version = node->lock.readLock();
+
+    while (true) {
+      if (node->shouldMoveRight(key)) {
+        Base* next = node->next;
+        if (!node->lock.validate(version))
+          goto restart;
+        node = next;
+        version = node->lock.readLock();
+        continue;
+      }
+
+      if (node->isLeaf)
+        return static_cast<Leaf*>(node);
+
+      auto* inner = static_cast<Inner*>(node);
+      Base* child = inner->children[inner->childIndex(key)];
+      if (!inner->lock.validate(version))
+        goto restart;
+      node = child;
+      version = node->lock.readLock();
+    }
+  }
+
+  // Top-down pass that splits the first full node on the path to key. The
+  // parent is write locked for the split, so it needs the exact parent and
+  // restarts rather than moving right.
+  void splitPath(const T& key) {
+  restart:
+    Base* node = root.load();
+    uint64_t version = node->lock.readLock();
+    Inner* parent = nullptr;
+    uint64_t parentVersion = 0;
+
+    while (true) {
+      bool moveRight = node->shouldMoveRight(key),
+           full = node->isLeaf ? static_cast<Leaf*>(node)->isFull()
+                               : static_cast<Inner*>(node)->isFull();
+      if (!node->lock.validate(version) || moveRight)
+        goto restart;
+
+      if (full) {
+        if (parent != nullptr && !parent->lock.upgrade(parentVersion))
+          goto restart;
+        if (!node->lock.upgrade(version)) {
+          if (parent != nullptr)
+            parent->lock.writeUnlock();
+          goto restart;
+        }
+        // Another thread grew the tree above us
+        if (parent == nullptr && node != root.load()) {
+          node->lock.writeUnlock();
+          goto restart;
+        }
+
+        T sep;
+        Base* right = node->isLeaf ? static_cast<Base*>(
+                                         static_cast<Leaf*>(node)->split(sep))
+                                   : static_cast<Inner*>(node)->split(sep);
+        if (parent != nullptr) {
+          parent->insert(sep, right);
+        } else {
+          auto* newRoot = new Inner();
+          newRoot->keys[0] = sep;
+          newRoot->children[0] = node;
+          newRoot->children[1] = right;
+          newRoot->count = 1;
+          root.store(newRoot);
+        }
+
+        node->lock.writeUnlock();
+        if (parent != nullptr)
+          parent->lock.writeUnlock();
+        if (node->isLeaf)
+          return;
+        goto restart;
+      }
+
+      // Leaf has room again, let the caller retry
+      if (node->isLeaf)
+        return;
+
+      auto* inner = static_cast<Inner*>(node);
+      Base* child = inner->children[inner->childIndex(key)];
+      if (!inner->lock.validate(version))
+        goto restart;
+      parent = inner;
+      parentVersion = version;
+      node = child;
+      version = node->lock.readLock();
+    }
+  }
+
+  void cleanup_all(Base* node) {
+    if (!node->isLeaf) {
+      auto* inner = static_cast<Inner*>(node);
+      for (std::size_t i = 0; i <= inner->count; i++)
+        cleanup_all(inner->children[i]);
+      delete inner;
+    } else {
+      delete static_cast<Leaf*>(node);
+    }
+  }
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "NodeSearch.h"
+#include "OptimisticLock.h"
+#include "src/Common/NumaAllocator.h"
+
+namespace BLink {
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+template <class T>
+struct NodeBase : Numa::Allocated {
+  OptimisticLock lock;
+  const bool isLeaf;
+  uint16_t count{0};
+  // Upper bound (exclusive) of the keys in this node, only valid if next is set
+  T highKey{};
+  NodeBase<T>* next{nullptr};
+
+  explicit NodeBase(bool isLeaf) : isLeaf{isLeaf} {}
+
+  // Keys >= highKey have been moved to a right sibling by a split
+  bool shouldMoveRight(const T& key) const {
+    return next != nullptr && !(key < highKey);
+  }
+};
+
+template <class T, std::size_t NODE_SIZE>
+struct alignas(CACHE_LINE_SIZE) LeafNode : NodeBase<T> {
+  constexpr static std::size_t CAPACITY =
+      (NODE_SIZE - sizeof(NodeBase<T>)) / sizeof(T);
+  static_assert(CAPACITY >= 4, "Node too small");
+
+  T keys[CAPACITY];
+
+  LeafNode() : NodeBase<T>(true) {}
+
+  bool isFull() const { return this->count == CAPACITY; }
+
+  // count may be torn under optimistic reads, never index past the array
+  std::size_t size() const {
+    return std::min<std::size_t>(this->count, CAPACITY);
+  }
+
+  std::size_t lowerBound(const T& key) const {
+    return NodeSearch<T>::lowerBound(keys, size(), key);
+  }
+
+  bool contains(const T& key) const {
+    std::size_t idx = lowerBound(key);
+    return idx < size() && keys[idx] == key;
+  }
+
+  // Assumes the key is absent and the node is not full
+  void insert(const T& key) {
+    std::size_t idx = lowerBound(key);
+    std::copy_backward(keys + idx, keys + this->count,
+                       keys + this->count + 1);
+    keys[idx] = key;
+    this->count++;
+  }
+
+  bool remove(const T& key) {
+    std::size_t idx = lowerBound(key);
+    if (idx == this->count || keys[idx] != key)
+      return false;
+    std::copy(keys + idx + 1, keys + this->count, keys + idx);
+    this->count--;
+    return true;
+  }
+
+  // Moves the upper half into a new right sibling, sep is its smallest key
+  LeafNode* split(T& sep) {
+    auto* right = new LeafNode();
+    std::size_t mid = this->count / 2;
+    std::copy(keys + mid, keys + this->count, right->keys);
+    right->count = this->count - mid;
+    right->highKey = this->highKey;
+    right->next = this->next;
+
+    sep = right->keys[0];
+    this->count = mid;
+    this->highKey = sep;
+    this->next = right;
+    return right;
+  }
+};
+
+template <class T, std::size_t NODE_SIZE>
+struct alignas(CACHE_LINE_SIZE) InnerNode : NodeBase<T> {
+  constexpr static std::size_t CAPACITY =
+      (NODE_SIZE - sizeof(NodeBase<T>) - sizeof(NodeBase<T>*)) /
+      (sizeof(T) + sizeof(NodeBase<T>*));
+  static_assert(CAPACITY >= 3, "Node too small");
+
+  // children[i] holds the keys in [keys[i - 1], keys[i])
+  T keys[CAPACITY];
+  NodeBase<T>* children[CAPACITY + 1];
+
+  InnerNode() : NodeBase<T>(false) {}
+
+  bool isFull() const { return this->count == CAPACITY; }
+
+  std::size_t size() const {
+    return std::min<std::size_t>(this->count, CAPACITY);
+  }
+
+  std::size_t childIndex(const T& key) const {
+    return NodeSearch<T>::upperBound(keys, size(), key);
+  }
+
+  // Assumes the node is not full, right becomes the child after sep
+  void insert(const T& sep, NodeBase<T>* right) {
+    std::size_t idx = childIndex(sep);
+    std::copy_backward(keys + idx, keys + this->count,
+                       keys + this->count + 1);
+    std::copy_backward(children + idx + 1, children + this->count + 1,
+                       children + this->count + 2);
+    keys[idx] = sep;
+    children[idx + 1] = right;
+    this->count++;
+  }
+
+  // The middle key moves up into the parent as sep
+  InnerNode* split(T& sep) {
+    auto* right = new InnerNode();
+    std::size_t mid = this->count / 2;
+    sep = keys[mid];
+    std::copy(keys + mid + 1, keys + this->count, right->keys);
+    std::copy(children + mid + 1, children + this->count + 1, right->children);
+    right->count = this->count - mid - 1;
+    right->highKey = this->highKey;
+    right->next = this->next;
+
+    this->count = mid;
+    this->highKey = sep;
+    this->next = right;
+    return right;
+  }
+};
+}  // namespace BLink
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+namespace BLink {
+// Binary search, works for any ordered key type
+template <class T>
+struct ScalarSearch {
+  constexpr static bool SIMD = false;
+
+  // Number of keys < key
+  static std::size_t lowerBound(const T* keys, std::size_t n, const T& key) {
+    return std::lower_bound(keys, keys + n, key) - keys;
+  }
+
+  // Number of keys <= key
+  static std::size_t upperBound(const T* keys, std::size_t n, const T& key) {
+    return std::upper_bound(keys, keys + n, key) - keys;
+  }
+};
+
+// Vectorised linear scan over the sorted keys of a node, stopping at the
+// first vector that is not entirely on one side of the key. Only defined for
+// signed 32/64-bit integers as that is what the compare instructions handle.
+template <class T>
+struct SimdSearch {
+#if defined(__AVX2__)
+  constexpr static std::size_t VECTOR_BYTES = 32;
+#elif defined(__SSE4_2__)
+  constexpr static std::size_t VECTOR_BYTES = 16;
+#else
+  constexpr static std::size_t VECTOR_BYTES = 0;
+#endif
+  constexpr static bool SIMD = VECTOR_BYTES != 0 && std::is_integral_v<T> &&
+                               std::is_signed_v<T> &&
+                               (sizeof(T) == 4 || sizeof(T) == 8);
+  constexpr static std::size_t LANES = SIMD ? VECTOR_BYTES / sizeof(T) : 1;
+  constexpr static unsigned FULL_MASK = (1u << LANES) - 1;
+
+  static std::size_t lowerBound(const T* keys, std::size_t n, const T& key) {
+    std::size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+      // Lanes where keys[j] < key
+      unsigned mask = compareGreater(broadcast(key), load(keys + i));
+      if (mask != FULL_MASK)
+        return i + std::popcount(mask);
+    }
+    for (; i < n && keys[i] < key; i++)
+      ;
+    return i;
+  }
+
+  static std::size_t upperBound(const T* keys, std::size_t n, const T& key) {
+    std::size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+      // Lanes where keys[j] > key
+      unsigned mask = compareGreater(load(keys + i), broadcast(key));
+      if (mask != 0)
+        return i + LANES - std::popcount(mask);
+    }
+    for (; i < n && !(key < keys[i]); i++)
+      ;
+    return i;
+  }
+
+ private:
+#if defined(__AVX2__)
+  using Vector = __m256i;
+
+  static Vector load(const T* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+
+  static Vector broadcast(const T& key) {
+    if constexpr (sizeof(T) == 4)
+      return _mm256_set1_epi32(key);
+    else
+      return _mm256_set1_epi64x(key);
+  }
+
+  static unsigned compareGreater(Vector a, Vector b) {
+    if constexpr (sizeof(T) == 4)
+      return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b)));
+    else
+      return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(a, b)));
+  }
+#elif defined(__SSE4_2__)
+  using Vector = __m128i;
+
+  static Vector load(const T* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+
+  static Vector broadcast(const T& key) {
+    if constexpr (sizeof(T) == 4)
+      return _mm_set1_epi32(key);
+    else
+      return _mm_set1_epi64x(key);
+  }
+
+  static unsigned compareGreater(Vector a, Vector b) {
+    if constexpr (sizeof(T) == 4)
+      return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(a, b)));
+    else
+      return _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(a, b)));
+  }
+#else
+  using Vector = T;
+
+  static Vector load(const T* p) { return *p; }
+  static Vector broadcast(const T& key) { return key; }
+  static unsigned compareGreater(Vector a, Vector b) { return b < a; }
+#endif
+};
+
+// Picked at compile time from the key type and the target instruction set
+template <class T>
+using NodeSearch =
+    std::conditional_t<SimdSearch<T>::SIMD, SimdSearch<T>, ScalarSearch<T>>;
+}  // namespace BLink
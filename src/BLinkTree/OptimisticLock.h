@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace BLink {
+// Version lock for optimistic lock coupling. Bit 1 is the write lock, every
+// write unlock bumps the version so readers can validate what they read.
+struct OptimisticLock {
+  constexpr static uint64_t LOCKED = 2;
+
+  std::atomic<uint64_t> version{4};
+
+  // Spins while a writer holds the lock, returns the version to validate
+  uint64_t readLock() const {
+    uint64_t v = version.load(std::memory_order_acquire);
+    while (v & LOCKED) {
+      std::this_thread::yield();
+      v = version.load(std::memory_order_acquire);
+    }
+    return v;
+  }
+
+  bool validate(uint64_t v) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version.load(std::memory_order_relaxed) == v;
+  }
+
+  bool upgrade(uint64_t v) {
+    return version.compare_exchange_strong(v, v + LOCKED,
+                                           std::memory_order_acquire);
+  }
+
+  void writeUnlock() { version.fetch_add(LOCKED, std::memory_order_release); }
+};
+}  // namespace BLink
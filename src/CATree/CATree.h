@@ -0,0 +1,238 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Node.h"
+#include "src/Common/MemoryStats.h"
+
+// Contention-adapting search tree. A tree of route nodes over base nodes that
+// each hold a std::set under one lock, starting out as a single base node.
+// Base nodes whose lock is contended are split in two, runs of uncontended
+// operations join a base node with its neighbour again. Unlinked nodes may
+// still be locked by late operations, they are freed with the tree.
+template <class T>
+struct CATree {
+  using Node = CA::Node<T>;
+  using Route = CA::RouteNode<T>;
+  using Base = CA::BaseNode<T>;
+
+  // Red-black nodes in libstdc++ and libc++ carry a colour and three pointers
+  // ahead of the key
+  constexpr static std::size_t SET_NODE_BYTES =
+      (4 * sizeof(void*) + sizeof(T) + alignof(void*) - 1) / alignof(void*) *
+      alignof(void*);
+
+  std::atomic<Node*> root{new Base()};
+
+  ~CATree() {
+    cleanup_all(root.load());
+    for (Node* node : retired)
+      destroy(node);
+  }
+
+  bool operator[](const T& key) {
+    return withBase(key,
+                    [&key](Base* base) { return base->keys.contains(key); });
+  }
+
+  bool insert(const T& key) {
+    return withBase(
+        key, [&key](Base* base) { return base->keys.insert(key).second; });
+  }
+
+  bool remove(const T& key) {
+    return withBase(key,
+                    [&key](Base* base) { return base->keys.erase(key) == 1; });
+  }
+
+  // Locks each base node while counting its keys and skips the ones a split
+  // or join replaced meanwhile, so it is only exact while no update runs
+  MemoryStats memory_stats() {
+    MemoryStats stats;
+    std::vector<Node*> stack{root.load()};
+    while (!stack.empty()) {
+      Node* node = stack.back();
+      stack.pop_back();
+      if (node->isBase) {
+        auto* base = static_cast<Base*>(node);
+        // Not through lock(), a walk is no contention to adapt to
+        std::lock_guard lk{base->mut};
+        if (!base->valid)
+          continue;
+        stats.liveNodes++;
+        const std::size_t keys = base->keys.size();
+        stats.keys += keys;
+        stats.liveBytes += sizeof(Base) + keys * SET_NODE_BYTES;
+      } else {
+        auto* route = static_cast<Route*>(node);
+        stats.liveNodes++;
+        stats.liveBytes += sizeof(Route);
+        stack.push_back(route->left.load());
+        stack.push_back(route->right.load());
+      }
+    }
+
+    std::lock_guard lk{retiredMut};
+    stats.retiredNodes = retired.size();
+    for (Node* node : retired)
+      stats.retiredBytes += node->isBase ? sizeof(Base) : sizeof(Route);
+    return stats;
+  }
+
+ private:
+  std::mutex retiredMut;
+  std::vector<Node*> retired;
+
+  // Runs op on the base node of key under its lock, then adapts the base node
+  // to the contention seen
+  template <class Op>
+  bool withBase(const T& key, Op&& op) {
+    while (true) {
+      Base* base = findBase(key);
+      std::unique_lock<std::mutex> lk = base->lock();
+      if (!base->valid)
+        continue;
+
+      const bool result = op(base);
+      if (base->statistics > CA::SPLIT_ABOVE && base->keys.size() >= 2)
+        split(base, key);
+      else if (base->statistics < CA::JOIN_BELOW)
+        join(base, key);
+      return result;
+    }
+  }
+
+  Base* findBase(const T& key) {
+    Node* node = root.load();
+    while (!node->isBase) {
+      auto* route = static_cast<Route*>(node);
+      node = key < route->key ? route->left.load() : route->right.load();
+    }
+    return static_cast<Base*>(node);
+  }
+
+  // Route node right above node on the path to key, nullptr for the root.
+  // Only stable while node is locked and valid.
+  Route* findParent(Node* node, const T& key) {
+    Route* parent = nullptr;
+    Node* cur = root.load();
+    while (cur != node && !cur->isBase) {
+      parent = static_cast<Route*>(cur);
+      cur = key < parent->key ? parent->left.load() : parent->right.load();
+    }
+    return cur == node ? parent : nullptr;
+  }
+
+  void replace(Route* parent, Node* old, Node* node) {
+    if (parent == nullptr)
+      root.store(node);
+    else if (parent->left.load() == old)
+      parent->left.store(node);
+    else
+      parent->right.store(node);
+  }
+
+  // Splits the keys of a locked base node in half under a new route node
+  void split(Base* base, const T& key) {
+    Route* parent = findParent(base, key);
+    auto mid = std::next(base->keys.begin(), base->keys.size() / 2);
+    auto* left = new Base();
+    auto* right = new Base();
+    while (base->keys.begin() != mid)
+      left->keys.insert(left->keys.end(),
+                        base->keys.extract(base->keys.begin()));
+    right->keys.swap(base->keys);
+
+    replace(parent, base, new Route(*right->keys.begin(), left, right));
+    base->valid = false;
+    retire(base);
+  }
+
+  // Joins a locked base node with its closest neighbour under the same parent
+  // and unlinks the parent. Gives up if any other node it needs is locked.
+  void join(Base* base, const T& key) {
+    Route* parent = findParent(base, key);
+    if (parent == nullptr) {
+      base->statistics = 0;
+      return;
+    }
+    const bool isLeft = parent->left.load() == base;
+    auto [neighbour, neighbourParent] = closest(parent, isLeft);
+    std::unique_lock<std::mutex> neighbourLk{neighbour->mut, std::try_to_lock};
+    if (!neighbourLk.owns_lock() || !neighbour->valid)
+      return;
+    std::unique_lock<std::mutex> parentLk{parent->mut, std::try_to_lock};
+    if (!parentLk.owns_lock() || !parent->valid)
+      return;
+    Route* grandparent = findParent(parent, key);
+    std::unique_lock<std::mutex> grandparentLk;
+    if (grandparent != nullptr) {
+      grandparentLk = std::unique_lock{grandparent->mut, std::try_to_lock};
+      if (!grandparentLk.owns_lock() || !grandparent->valid)
+        return;
+    }
+    if (grandparent == nullptr ? root.load() != parent
+                               : !isChild(grandparent, parent))
+      return;
+    // The neighbour may have been replaced before it was locked
+    if (closest(parent, isLeft).first != neighbour)
+      return;
+
+    auto* joined = new Base();
+    Base* low = isLeft ? base : neighbour;
+    Base* high = isLeft ? neighbour : base;
+    joined->keys.swap(low->keys);
+    while (!high->keys.empty())
+      joined->keys.insert(joined->keys.end(),
+                          high->keys.extract(high->keys.begin()));
+
+    replace(neighbourParent, neighbour, joined);
+    replace(grandparent, parent,
+            isLeft ? parent->right.load() : parent->left.load());
+    base->valid = neighbour->valid = parent->valid = false;
+    retire(base);
+    retire(neighbour);
+    retire(parent);
+  }
+
+  static bool isChild(Route* parent, Node* node) {
+    return parent->left.load() == node || parent->right.load() == node;
+  }
+
+  // Base node next to the isLeft side of parent and the route node above it
+  static std::pair<Base*, Route*> closest(Route* parent, bool isLeft) {
+    Route* above = parent;
+    Node* node = isLeft ? parent->right.load() : parent->left.load();
+    while (!node->isBase) {
+      above = static_cast<Route*>(node);
+      node = isLeft ? above->left.load() : above->right.load();
+    }
+    return {static_cast<Base*>(node), above};
+  }
+
+  void retire(Node* node) {
+    std::lock_guard lk{retiredMut};
+    retired.push_back(node);
+  }
+
+  static void destroy(Node* node) {
+    if (node->isBase)
+      delete static_cast<Base*>(node);
+    else
+      delete static_cast<Route*>(node);
+  }
+
+  void cleanup_all(Node* node) {
+    if (!node->isBase) {
+      auto* route = static_cast<Route*>(node);
+      cleanup_all(route->left.load());
+      cleanup_all(route->right.load());
+    }
+    destroy(node);
+  }
+};
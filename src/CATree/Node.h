@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <set>
+
+#include "src/Common/NumaAllocator.h"
+
+namespace CA {
+// Lock statistics of a base node, as in Sagonas and Winblad's CA tree. Every
+// acquisition that had to wait adds CONTENDED, every other one takes off
+// UNCONTENDED, and the base node is split or joined once the sum leaves
+// [JOIN_BELOW, SPLIT_ABOVE].
+constexpr int CONTENDED = 250, UNCONTENDED = 1;
+constexpr int SPLIT_ABOVE = 1000, JOIN_BELOW = -1000;
+
+template <class T>
+struct Node : Numa::Allocated {
+  const bool isBase;
+
+  explicit Node(bool isBase) : isBase{isBase} {}
+};
+
+// Keys below key are on the left, the others on the right. The lock and valid
+// are only used by joins, which unlink route nodes.
+template <class T>
+struct RouteNode : Node<T> {
+  const T key;
+  std::atomic<Node<T>*> left, right;
+  std::mutex mut;
+  bool valid{true};
+
+  RouteNode(const T& key, Node<T>* left, Node<T>* right)
+      : Node<T>{false}, key{key}, left{left}, right{right} {}
+};
+
+// Sequential set of every key in its range, guarded by its lock. A split or
+// join replaces the node and marks it invalid, so an operation that locked
+// it too late retries from the root.
+template <class T>
+struct BaseNode : Node<T> {
+  using Set = std::set<T, std::less<T>, Numa::Allocator<T>>;
+
+  Set keys;
+  std::mutex mut;
+  int statistics{0};
+  bool valid{true};
+
+  BaseNode() : Node<T>{true} {}
+
+  // Locks the node and records whether that had to wait
+  std::unique_lock<std::mutex> lock() {
+    std::unique_lock<std::mutex> lk{mut, std::try_to_lock};
+    if (lk.owns_lock()) {
+      statistics -= UNCONTENDED;
+    } else {
+      lk.lock();
+      statistics += CONTENDED;
+    }
+    return lk;
+  }
+};
+}  // namespace CA
@@ -4,18 +4,35 @@
 #include <set>
 #include <shared_mutex>
 
-template <typename T>
+#include "src/Common/BigReaderLock.h"
+#include "src/Common/LockProfiler.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/NumaAllocator.h"
+
+// Mutex can be any SharedMutex, BigReaderLock for read-mostly workloads
+template <typename T, typename Mutex = std::shared_mutex>
 struct CGLBBST {
-  std::set<T> tree;
-  std::shared_mutex mut{};
+  using ReadLock =
+      LockProfiler::ProfiledLock<std::shared_lock<Mutex>>;
+  using WriteLock =
+      LockProfiler::ProfiledLock<std::unique_lock<Mutex>>;
+
+  // Red-black nodes in libstdc++ and libc++ carry a colour and three pointers
+  // ahead of the key
+  constexpr static std::size_t SET_NODE_BYTES =
+      (4 * sizeof(void*) + sizeof(T) + alignof(void*) - 1) / alignof(void*) *
+      alignof(void*);
+
+  std::set<T, std::less<T>, Numa::Allocator<T>> tree;
+  Mutex mut{};
 
   bool operator[](const T& key) {
-    std::shared_lock lk{mut};
+    ReadLock lk{mut, 0};
     return tree.contains(key);
   }
 
   bool insert(const T& key) {
-    std::unique_lock lk{mut};
+    WriteLock lk{mut, 0};
     if (tree.contains(key))
       return false;
     tree.insert(key);
@@ -23,10 +40,26 @@ struct CGLBBST {
   }
 
   bool remove(const T& key) {
-    std::unique_lock lk{mut};
+    WriteLock lk{mut, 0};
     if (!tree.contains(key))
       return false;
     tree.erase(key);
     return true;
   }
+
+  MemoryStats memory_stats() {
+    std::shared_lock lk{mut};
+    MemoryStats stats;
+    stats.keys = stats.liveNodes = tree.size();
+    stats.liveBytes = stats.liveNodes * SET_NODE_BYTES;
+    return stats;
+  }
+
+  // Calls f with every key in ascending order under the read lock
+  template <class F>
+  void for_each(F&& f) {
+    std::shared_lock lk{mut};
+    for (const T& key : tree)
+      f(key);
+  }
 };
\ No newline at end of file
@@ -1,19 +1,35 @@
 #pragma once
 
+#include <cstddef>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
+#include <utility>
+#include <vector>
 
 #include "CGLBSTNode.h"
+#include "src/Common/BigReaderLock.h"
+#include "src/Common/LockProfiler.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/ShapeStats.h"
 
-template <class T>
+// Mutex can be any SharedMutex, BigReaderLock for read-mostly workloads
+template <class T, class Mutex = std::shared_mutex>
 struct CGLBST {
+  using ReadLock =
+      LockProfiler::ProfiledLock<std::shared_lock<Mutex>>;
+  using WriteLock =
+      LockProfiler::ProfiledLock<std::unique_lock<Mutex>>;
+
   CGLBSTNode<T>* root = nullptr;
-  std::shared_mutex mut{};
+  Mutex mut{};
+  // Guarded by mut
+  std::size_t allocatedNodes = 0;
 
   ~CGLBST() { cleanup_all(root); }
 
   bool operator[](const T& key) {
-    std::shared_lock<std::shared_mutex> lk{mut};
+    ReadLock lk{mut, 0};
     CGLBSTNode<T>* curNode = root;
 
     while (curNode != nullptr) {
@@ -28,35 +44,40 @@ struct CGLBST {
   }
 
   bool insert(const T& key) {
-    std::unique_lock<std::shared_mutex> lk{mut};
+    WriteLock lk{mut, 0};
     if (root == nullptr) {
       root = new CGLBSTNode<T>(key);
+      allocatedNodes++;
       return true;
     }
 
     CGLBSTNode<T>* cur = root;
 
     while (cur->key != key) {
+      cur->size++;
       if (key < cur->key) {
         if (cur->left == nullptr) {
           cur->left = new CGLBSTNode<T>(key);
+          allocatedNodes++;
           return true;
         }
         cur = cur->left;
       } else {
         if (cur->right == nullptr) {
           cur->right = new CGLBSTNode<T>(key);
+          allocatedNodes++;
           return true;
         }
         cur = cur->right;
       }
     }
 
+    shrinkPathTo(key);
     return false;
   }
 
   bool remove(const T& key) {
-    std::unique_lock<std::shared_mutex> lk{mut};
+    WriteLock lk{mut, 0};
     if (root == nullptr)
       return false;
 
@@ -77,9 +98,11 @@ struct CGLBST {
     }
 
     if (cur->left == nullptr) {
+      shrinkPathTo(key);
       *curPtr = cur->right;
       return true;
     } else if (cur->right == nullptr) {
+      shrinkPathTo(key);
       *curPtr = cur->left;
       return true;
     }
@@ -91,11 +114,115 @@ struct CGLBST {
       inorderSuccessor = inorderSuccessor->right;
     }
 
+    // The path to the node taken out goes through cur
+    shrinkPathTo(inorderSuccessor->key);
     cur->key = inorderSuccessor->key;
     *inorderSuccessorPtr = inorderSuccessor->left;
     return true;
   }
 
+  // Number of keys, read off the root
+  std::size_t size() {
+    ReadLock lk{mut, 0};
+    return sizeOf(root);
+  }
+
+  // Number of keys below key, in O(height) from the subtree sizes
+  std::size_t rank(const T& key) {
+    ReadLock lk{mut, 0};
+    std::size_t below = 0;
+    for (CGLBSTNode<T>* cur = root; cur != nullptr;) {
+      if (key < cur->key) {
+        cur = cur->left;
+      } else if (key > cur->key) {
+        below += sizeOf(cur->left) + 1;
+        cur = cur->right;
+      } else {
+        return below + sizeOf(cur->left);
+      }
+    }
+    return below;
+  }
+
+  // The key with k keys below it, nothing if k is not below size()
+  std::optional<T> select(std::size_t k) {
+    ReadLock lk{mut, 0};
+    for (CGLBSTNode<T>* cur = root; cur != nullptr;) {
+      const std::size_t left = sizeOf(cur->left);
+      if (k < left) {
+        cur = cur->left;
+      } else if (k == left) {
+        return cur->key;
+      } else {
+        k -= left + 1;
+        cur = cur->right;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Removed nodes are never freed, they show up as retired
+  MemoryStats memory_stats() {
+    std::shared_lock<Mutex> lk{mut};
+    MemoryStats stats;
+    std::vector<CGLBSTNode<T>*> stack;
+    if (root != nullptr)
+      stack.push_back(root);
+    while (!stack.empty()) {
+      CGLBSTNode<T>* node = stack.back();
+      stack.pop_back();
+      stats.liveNodes++;
+      if (node->left != nullptr)
+        stack.push_back(node->left);
+      if (node->right != nullptr)
+        stack.push_back(node->right);
+    }
+    stats.keys = stats.liveNodes;
+    stats.liveBytes = stats.liveNodes * sizeof(CGLBSTNode<T>);
+    stats.retiredNodes = allocatedNodes - stats.liveNodes;
+    stats.retiredBytes = stats.retiredNodes * sizeof(CGLBSTNode<T>);
+    return stats;
+  }
+
+  ShapeStats shape_stats() {
+    std::shared_lock<Mutex> lk{mut};
+    return shapeOf(
+        root,
+        [](CGLBSTNode<T>* node) { return std::pair{node->left, node->right}; },
+        [](CGLBSTNode<T>*) { return ShapeStats::Kind::KEY; });
+  }
+
+  int height() { return shape_stats().height; }
+
+  // Calls f with every key in ascending order under the read lock
+  template <class F>
+  void for_each(F&& f) {
+    std::shared_lock<Mutex> lk{mut};
+    std::vector<CGLBSTNode<T>*> stack;
+    for (CGLBSTNode<T>* node = root; node != nullptr || !stack.empty();) {
+      for (; node != nullptr; node = node->left)
+        stack.push_back(node);
+      node = stack.back();
+      stack.pop_back();
+      f(node->key);
+      node = node->right;
+    }
+  }
+
+  static std::size_t sizeOf(const CGLBSTNode<T>* node) {
+    return node == nullptr ? 0 : node->size;
+  }
+
+  // Takes one off the size of every node above the one holding key, for an
+  // insert that found key after counting it on the way down or a remove
+  // about to unlink that node. Caller holds the write lock.
+  void shrinkPathTo(const T& key) {
+    for (CGLBSTNode<T>* cur = root; cur->key != key;) {
+      cur->size--;
+      cur = key < cur->key ? cur->left : cur->right;
+    }
+  }
+
   void cleanup_all(CGLBSTNode<T>* node) {
     if (node == nullptr)
       return;
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <cstddef>
+
+#include "src/Common/NumaAllocator.h"
+
 template <class T>
-struct CGLBSTNode {
+struct CGLBSTNode : Numa::Allocated {
   T key;
   CGLBSTNode<T>*left, *right;
+  // Keys in the subtree rooted here, this one included
+  std::size_t size = 1;
 
   explicit CGLBSTNode(const T& key, CGLBSTNode* left = nullptr,
                       CGLBSTNode* right = nullptr)
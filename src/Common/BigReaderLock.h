@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// Reader-writer lock for read-mostly data, a drop-in for std::shared_mutex.
+// Each reader only writes to the indicator of its own slot, so readers on
+// different cores never share a cache line. A writer raises its flag, then
+// waits for every slot to drain, which makes writes cost a pass over all
+// SLOTS. Writers take precedence over readers that come after them.
+struct BigReaderLock {
+  constexpr static std::size_t SLOTS = 64;
+
+  void lock_shared() {
+    std::atomic<int64_t>& readers = slots[slot()].readers;
+    while (true) {
+      readers.fetch_add(1, std::memory_order_seq_cst);
+      if (!writer.load(std::memory_order_seq_cst))
+        return;
+      readers.fetch_sub(1, std::memory_order_relaxed);
+      while (writer.load(std::memory_order_relaxed))
+        std::this_thread::yield();
+    }
+  }
+
+  bool try_lock_shared() {
+    std::atomic<int64_t>& readers = slots[slot()].readers;
+    readers.fetch_add(1, std::memory_order_seq_cst);
+    if (!writer.load(std::memory_order_seq_cst))
+      return true;
+    readers.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  void unlock_shared() {
+    slots[slot()].readers.fetch_sub(1, std::memory_order_release);
+  }
+
+  void lock() {
+    writers.lock();
+    writer.store(true, std::memory_order_seq_cst);
+    for (const Slot& s : slots) {
+      while (s.readers.load(std::memory_order_seq_cst) != 0)
+        std::this_thread::yield();
+    }
+  }
+
+  bool try_lock() {
+    if (!writers.try_lock())
+      return false;
+    writer.store(true, std::memory_order_seq_cst);
+    for (const Slot& s : slots) {
+      if (s.readers.load(std::memory_order_seq_cst) != 0) {
+        unlock();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void unlock() {
+    writer.store(false, std::memory_order_release);
+    writers.unlock();
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<int64_t> readers{0};
+  };
+
+  Slot slots[SLOTS];
+  alignas(64) std::atomic<bool> writer{false};
+  std::mutex writers;
+
+  // Threads are dealt out to the slots in turn, a reader has to release in
+  // the slot it acquired in
+  static std::size_t slot() {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t mine = next.fetch_add(1) % SLOTS;
+    return mine;
+  }
+};
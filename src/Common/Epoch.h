@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Thread slots and epoch based reclamation shared by the trees that retire
+// nodes or versions other threads may still be reading
+namespace Epoch {
+constexpr int MAX_THREADS = 256;
+
+// Small id of the calling thread, handed back when the thread exits so that
+// short lived threads do not run out of slots
+inline int threadSlot() {
+  static std::atomic<bool> used[MAX_THREADS]{};
+  struct Slot {
+    int id = 0;
+    Slot() {
+      while (used[id].exchange(true))
+        id = (id + 1) % MAX_THREADS;
+    }
+    ~Slot() { used[id].store(false); }
+  };
+  thread_local Slot slot;
+  return slot.id;
+}
+
+// Epoch based reclamation. Operations pin the current epoch while they run,
+// an object retired in epoch e is freed once the epoch reached e + 2 because
+// every operation that could still see it has finished by then. Every
+// ADVANCE_EVERY retirements a thread tries to advance the epoch and frees
+// what is safe, large objects want a small batch.
+template <class Retired, std::size_t ADVANCE_EVERY = 64>
+struct Manager {
+  constexpr static uint64_t IDLE = std::numeric_limits<uint64_t>::max();
+
+  struct Guard {
+    std::atomic<uint64_t>& announced;
+
+    explicit Guard(Manager& m)
+        : announced{m.locals[threadSlot()].announced} {
+      announced.store(m.epoch.load());
+    }
+    Guard(const Guard&) = delete;
+    ~Guard() { announced.store(IDLE, std::memory_order_release); }
+  };
+
+  ~Manager() {
+    for (Local& local : locals) {
+      for (auto& [retiredAt, retired] : local.limbo)
+        delete retired;
+    }
+  }
+
+  // Guards must not be nested
+  Guard pin() { return Guard{*this}; }
+
+  // Caller is pinned
+  void retire(Retired* retired) {
+    Local& local = locals[threadSlot()];
+    local.limbo.emplace_back(epoch.load(), retired);
+    pendingCount.fetch_add(1, std::memory_order_relaxed);
+    if (local.limbo.size() % ADVANCE_EVERY != 0)
+      return;
+
+    tryAdvance();
+    const uint64_t current = epoch.load();
+    auto safe = std::find_if(
+        local.limbo.begin(), local.limbo.end(),
+        [current](const auto& entry) { return entry.first + 2 > current; });
+    for (auto it = local.limbo.begin(); it != safe; ++it)
+      delete it->second;
+    pendingCount.fetch_sub(safe - local.limbo.begin(),
+                           std::memory_order_relaxed);
+    local.limbo.erase(local.limbo.begin(), safe);
+  }
+
+  // Retired objects not freed yet, only exact while nobody retires
+  std::size_t pending() const {
+    return pendingCount.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct alignas(64) Local {
+    std::atomic<uint64_t> announced{IDLE};
+    // Only touched by the thread owning the slot
+    std::vector<std::pair<uint64_t, Retired*>> limbo;
+  };
+
+  std::atomic<uint64_t> epoch{0};
+  // Sum of the limbo sizes, which other threads cannot read
+  std::atomic<std::size_t> pendingCount{0};
+  Local locals[MAX_THREADS];
+
+  void tryAdvance() {
+    uint64_t e = epoch.load();
+    for (const Local& local : locals) {
+      const uint64_t announced = local.announced.load();
+      if (announced != IDLE && announced != e)
+        return;
+    }
+    epoch.compare_exchange_strong(e, e + 1);
+  }
+};
+}  // namespace Epoch
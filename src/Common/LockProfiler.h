@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#ifdef LOCK_PROFILING_ENABLED
+#include <chrono>
+#include <mutex>
+#include <utility>
+#include <vector>
+#endif
+
+// Wait time, hold time and acquisitions of the lock-based trees per lock
+// level, compiled in with -DLOCK_PROFILING_ENABLED (the WITH_LOCK_PROFILING
+// CMake option). A level is the depth of the locked node, grouped into
+// power of two buckets, a tree with a single lock only uses level 0.
+// Without the define ProfiledLock is the plain lock.
+namespace LockProfiler {
+constexpr int NUM_LEVELS = 16;
+
+// 0, 1, 2-3, 4-7, ... with everything deeper in the last bucket
+constexpr int level(uint64_t depth) {
+  const int bucket = std::bit_width(depth);
+  return bucket < NUM_LEVELS ? bucket : NUM_LEVELS - 1;
+}
+
+struct LevelStats {
+  uint64_t acquisitions = 0, waitNs = 0, holdNs = 0;
+};
+
+using Profile = std::array<LevelStats, NUM_LEVELS>;
+
+#ifdef LOCK_PROFILING_ENABLED
+constexpr bool ENABLED = true;
+
+using Clock = std::chrono::steady_clock;
+
+struct alignas(64) Block {
+  std::atomic<uint64_t> acquisitions[NUM_LEVELS]{}, waitNs[NUM_LEVELS]{},
+      holdNs[NUM_LEVELS]{};
+};
+
+// Blocks are handed back when their thread exits and reused by the next one
+struct Registry {
+  std::mutex mut;
+  std::vector<Block*> all, unused;
+};
+
+inline Registry& registry() {
+  static Registry r;
+  return r;
+}
+
+inline Block& localBlock() {
+  struct Owner {
+    Block* block;
+    Owner() {
+      std::lock_guard lk{registry().mut};
+      if (registry().unused.empty()) {
+        block = new Block();
+        registry().all.push_back(block);
+      } else {
+        block = registry().unused.back();
+        registry().unused.pop_back();
+      }
+    }
+    ~Owner() {
+      std::lock_guard lk{registry().mut};
+      registry().unused.push_back(block);
+    }
+  };
+  thread_local Owner owner;
+  return *owner.block;
+}
+
+// Only the owning thread writes its block
+inline void add(std::atomic<uint64_t>& value, uint64_t n) {
+  value.store(value.load(std::memory_order_relaxed) + n,
+              std::memory_order_relaxed);
+}
+
+inline uint64_t elapsedNs(Clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                              since)
+      .count();
+}
+
+// std::unique_lock or std::shared_lock that times its acquisition and how
+// long it was held until it is unlocked, moved over or destroyed
+template <class Lock>
+struct ProfiledLock : Lock {
+  ProfiledLock() = default;
+  ProfiledLock(typename Lock::mutex_type& m, int level) : level{level} {
+    const Clock::time_point start = Clock::now();
+    Lock::operator=(Lock{m});
+    acquiredAt = Clock::now();
+    Block& block = localBlock();
+    add(block.acquisitions[level], 1);
+    add(block.waitNs[level],
+        std::chrono::duration_cast<std::chrono::nanoseconds>(acquiredAt -
+                                                             start)
+            .count());
+  }
+  ProfiledLock(ProfiledLock&&) = default;
+  ~ProfiledLock() { recordHold(); }
+
+  ProfiledLock& operator=(ProfiledLock&& other) {
+    recordHold();
+    Lock::operator=(std::move(other));
+    level = other.level;
+    acquiredAt = other.acquiredAt;
+    return *this;
+  }
+
+  void unlock() {
+    recordHold();
+    Lock::unlock();
+  }
+
+ private:
+  int level = 0;
+  Clock::time_point acquiredAt{};
+
+  void recordHold() {
+    if (this->owns_lock())
+      add(localBlock().holdNs[level], elapsedNs(acquiredAt));
+  }
+};
+
+inline Profile collect() {
+  Profile profile{};
+  std::lock_guard lk{registry().mut};
+  for (const Block* block : registry().all) {
+    for (int l = 0; l < NUM_LEVELS; l++) {
+      profile[l].acquisitions +=
+          block->acquisitions[l].load(std::memory_order_relaxed);
+      profile[l].waitNs += block->waitNs[l].load(std::memory_order_relaxed);
+      profile[l].holdNs += block->holdNs[l].load(std::memory_order_relaxed);
+    }
+  }
+  return profile;
+}
+
+// Racy against threads holding profiled locks, call it between runs
+inline void reset() {
+  std::lock_guard lk{registry().mut};
+  for (Block* block : registry().all) {
+    for (int l = 0; l < NUM_LEVELS; l++) {
+      block->acquisitions[l].store(0, std::memory_order_relaxed);
+      block->waitNs[l].store(0, std::memory_order_relaxed);
+      block->holdNs[l].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+#else
+constexpr bool ENABLED = false;
+
+template <class Lock>
+struct ProfiledLock : Lock {
+  ProfiledLock() = default;
+  ProfiledLock(typename Lock::mutex_type& m, int) : Lock{m} {}
+};
+
+inline Profile collect() {
+  return {};
+}
+inline void reset() {}
+#endif
+}  // namespace LockProfiler
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+
+// Bytes a tree holds, as sizeof of what it allocated. Allocator overhead is
+// not included. Trees walk their nodes to fill this in, so the numbers are
+// only exact while no update is running.
+struct MemoryStats {
+  std::size_t keys = 0;
+  std::size_t liveNodes = 0, liveBytes = 0;
+  // Unlinked from the tree and not freed yet, or leaked by the algorithm
+  std::size_t retiredNodes = 0, retiredBytes = 0;
+  // Operation records and versions kept next to the nodes
+  std::size_t descriptorBytes = 0;
+
+  std::size_t totalBytes() const {
+    return liveBytes + retiredBytes + descriptorBytes;
+  }
+
+  double bytesPerKey() const {
+    return keys == 0 ? 0.0 : static_cast<double>(totalBytes()) / keys;
+  }
+
+  MemoryStats& operator+=(const MemoryStats& other) {
+    keys += other.keys;
+    liveNodes += other.liveNodes;
+    liveBytes += other.liveBytes;
+    retiredNodes += other.retiredNodes;
+    retiredBytes += other.retiredBytes;
+    descriptorBytes += other.descriptorBytes;
+    return *this;
+  }
+};
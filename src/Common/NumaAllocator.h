@@ -0,0 +1,356 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#ifdef NUMA_ENABLED
+#include <numa.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#endif
+
+// NUMA aware placement of tree nodes. Node types derive from Numa::Allocated
+// and std containers take Numa::Allocator. With libnuma (NUMA_ENABLED, set by
+// CMake when it finds the library) nodes come from per NUMA node pools:
+//  - LOCAL places a node on the NUMA node of the allocating thread, so a
+//    subtree built by a pinned thread stays on its socket (first touch).
+//  - INTERLEAVE spreads the pages of the pool round robin over all nodes.
+// Freed nodes go back to the free list of the NUMA node they came from.
+// Without libnuma, or on a kernel without NUMA support, everything is plain
+// operator new on a single node.
+namespace Numa {
+enum class Placement { LOCAL, INTERLEAVE };
+
+inline std::atomic<Placement>& globalPlacement() {
+  static std::atomic<Placement> placement{Placement::LOCAL};
+  return placement;
+}
+
+inline Placement*& scopedPlacement() {
+  thread_local Placement* placement = nullptr;
+  return placement;
+}
+
+inline void setPlacement(Placement placement) {
+  globalPlacement().store(placement);
+}
+
+// Placement of the current thread, a ScopedPlacement wins over the global one
+inline Placement placement() {
+  Placement* scoped = scopedPlacement();
+  return scoped != nullptr ? *scoped : globalPlacement().load();
+}
+
+// Overrides the placement of the current thread, e.g. to interleave a
+// subtree that every socket reads while the rest stays local
+struct ScopedPlacement {
+  explicit ScopedPlacement(Placement placement)
+      : placement{placement}, previous{scopedPlacement()} {
+    scopedPlacement() = &this->placement;
+  }
+  ScopedPlacement(const ScopedPlacement&) = delete;
+  ~ScopedPlacement() { scopedPlacement() = previous; }
+
+ private:
+  Placement placement;
+  Placement* previous;
+};
+
+#ifdef NUMA_ENABLED
+constexpr bool ENABLED = true;
+
+inline bool available() {
+  static const bool available = numa_available() >= 0;
+  return available;
+}
+
+inline int nodeCount() {
+  return available() ? numa_max_node() + 1 : 1;
+}
+
+inline int nodeOfCpu(int cpu) {
+  const int node = available() ? numa_node_of_cpu(cpu) : 0;
+  return node < 0 ? 0 : node;
+}
+
+// Threads are expected to be pinned, the node is looked up once
+inline int currentNode() {
+  thread_local const int node = nodeOfCpu(sched_getcpu());
+  return node;
+}
+
+// Objects live in chunks aligned to CHUNK_SIZE, so the header of the chunk,
+// and with it the pool an object belongs to, is found by masking its address
+constexpr std::size_t CHUNK_SIZE = std::size_t{1} << 20;
+constexpr std::size_t HEADER_SIZE = 64;
+constexpr std::size_t GRANULARITY = 16;
+constexpr std::size_t MAX_SMALL = 4096;
+constexpr int NUM_CLASSES = MAX_SMALL / GRANULARITY;
+constexpr int LARGE = -1;
+// Blocks moved between a thread cache and its pool at once
+constexpr int BATCH = 32;
+
+struct ChunkHeader {
+  void* raw;
+  std::size_t rawSize;
+  int sizeClass;
+  int pool;
+};
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+// Maps at least size bytes of which the part after HEADER_SIZE starts at a
+// CHUNK_SIZE boundary plus HEADER_SIZE
+inline ChunkHeader* mapChunk(std::size_t size, int pool, int sizeClass) {
+  const std::size_t rawSize = size + CHUNK_SIZE;
+  void* raw;
+  if (!available())
+    raw = std::malloc(rawSize);
+  else if (pool == nodeCount())
+    raw = numa_alloc_interleaved(rawSize);
+  else
+    raw = numa_alloc_onnode(rawSize, pool);
+  if (raw == nullptr)
+    throw std::bad_alloc();
+
+  const uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + CHUNK_SIZE -
+                             1) & ~(CHUNK_SIZE - 1);
+  return new (reinterpret_cast<void*>(aligned))
+      ChunkHeader{raw, rawSize, sizeClass, pool};
+}
+
+inline void unmapChunk(ChunkHeader* chunk) {
+  if (available())
+    numa_free(chunk->raw, chunk->rawSize);
+  else
+    std::free(chunk->raw);
+}
+
+inline ChunkHeader* chunkOf(void* p) {
+  return reinterpret_cast<ChunkHeader*>(reinterpret_cast<uintptr_t>(p) &
+                                        ~(CHUNK_SIZE - 1));
+}
+
+// Free lists and bump regions of one NUMA node, the last pool is the
+// interleaved one
+struct Pool {
+  struct SizeClass {
+    FreeBlock* free = nullptr;
+    char *bump = nullptr, *end = nullptr;
+  };
+
+  std::mutex mut;
+  SizeClass classes[NUM_CLASSES];
+
+  // Moves up to BATCH blocks into list, returns how many
+  int take(int pool, int sizeClass, FreeBlock*& list) {
+    const std::size_t blockSize = (sizeClass + 1) * GRANULARITY;
+    SizeClass& c = classes[sizeClass];
+    std::lock_guard lk{mut};
+    int taken = 0;
+    for (; taken < BATCH && c.free != nullptr; taken++) {
+      FreeBlock* block = c.free;
+      c.free = block->next;
+      block->next = list;
+      list = block;
+    }
+    for (; taken < BATCH; taken++) {
+      if (c.bump + blockSize > c.end) {
+        ChunkHeader* chunk = mapChunk(CHUNK_SIZE, pool, sizeClass);
+        c.bump = reinterpret_cast<char*>(chunk) + HEADER_SIZE;
+        c.end = reinterpret_cast<char*>(chunk) + CHUNK_SIZE;
+      }
+      auto* block = reinterpret_cast<FreeBlock*>(c.bump);
+      c.bump += blockSize;
+      block->next = list;
+      list = block;
+    }
+    return taken;
+  }
+
+  void give(int sizeClass, FreeBlock* first, FreeBlock* last) {
+    SizeClass& c = classes[sizeClass];
+    std::lock_guard lk{mut};
+    last->next = c.free;
+    c.free = first;
+  }
+};
+
+// Pools are never torn down, chunks are reused for the life of the process
+inline Pool* pools() {
+  static Pool* pools = new Pool[nodeCount() + 1];
+  return pools;
+}
+
+// Blocks of the pool the thread allocates from, handed back on thread exit
+struct ThreadCache {
+  struct SizeClass {
+    FreeBlock* free = nullptr;
+    int count = 0;
+  };
+
+  int pool = -1;
+  SizeClass classes[NUM_CLASSES];
+
+  ~ThreadCache() { flush(); }
+
+  void flush() {
+    for (int c = 0; c < NUM_CLASSES; c++) {
+      if (classes[c].free == nullptr)
+        continue;
+      FreeBlock* last = classes[c].free;
+      while (last->next != nullptr)
+        last = last->next;
+      pools()[pool].give(c, classes[c].free, last);
+      classes[c] = SizeClass{};
+    }
+  }
+};
+
+inline ThreadCache& threadCache() {
+  thread_local ThreadCache cache;
+  return cache;
+}
+
+inline int targetPool() {
+  if (!available())
+    return 0;
+  return placement() == Placement::INTERLEAVE ? nodeCount() : currentNode();
+}
+
+inline void* allocate(std::size_t size) {
+  if (size > MAX_SMALL) {
+    return reinterpret_cast<char*>(
+               mapChunk(HEADER_SIZE + size, targetPool(), LARGE)) +
+           HEADER_SIZE;
+  }
+
+  const int sizeClass =
+      (std::max<std::size_t>(size, 1) + GRANULARITY - 1) / GRANULARITY - 1;
+  ThreadCache& cache = threadCache();
+  const int pool = targetPool();
+  if (cache.pool != pool) {
+    if (cache.pool != -1)
+      cache.flush();
+    cache.pool = pool;
+  }
+
+  ThreadCache::SizeClass& c = cache.classes[sizeClass];
+  if (c.free == nullptr)
+    c.count = pools()[pool].take(pool, sizeClass, c.free);
+  FreeBlock* block = c.free;
+  c.free = block->next;
+  c.count--;
+  return block;
+}
+
+inline void deallocate(void* p) {
+  if (p == nullptr)
+    return;
+  ChunkHeader* chunk = chunkOf(p);
+  if (chunk->sizeClass == LARGE) {
+    unmapChunk(chunk);
+    return;
+  }
+
+  auto* block = static_cast<FreeBlock*>(p);
+  ThreadCache& cache = threadCache();
+  if (chunk->pool != cache.pool) {
+    block->next = nullptr;
+    pools()[chunk->pool].give(chunk->sizeClass, block, block);
+    return;
+  }
+
+  ThreadCache::SizeClass& c = cache.classes[chunk->sizeClass];
+  block->next = c.free;
+  c.free = block;
+  if (++c.count < 2 * BATCH)
+    return;
+  // Keep one batch, hand the rest back to the pool
+  FreeBlock* last = c.free;
+  for (int i = 1; i < BATCH; i++)
+    last = last->next;
+  FreeBlock* spill = last->next;
+  last->next = nullptr;
+  FreeBlock* spillLast = spill;
+  while (spillLast->next != nullptr)
+    spillLast = spillLast->next;
+  pools()[cache.pool].give(chunk->sizeClass, spill, spillLast);
+  c.count = BATCH;
+}
+#else
+constexpr bool ENABLED = false;
+
+inline int nodeCount() {
+  return 1;
+}
+inline int nodeOfCpu(int) {
+  return 0;
+}
+inline int currentNode() {
+  return 0;
+}
+
+inline void* allocate(std::size_t size) {
+  return ::operator new(size);
+}
+inline void deallocate(void* p) {
+  ::operator delete(p);
+}
+#endif
+
+// Base of node types, routes their new and delete through the pools. Blocks
+// are GRANULARITY aligned, a type aligned to at most HEADER_SIZE has a size
+// that keeps it aligned within its chunk. Anything aligned further bypasses
+// the pools.
+struct Allocated {
+  static void* operator new(std::size_t size) { return allocate(size); }
+  static void* operator new(std::size_t size, std::align_val_t align) {
+    if (ENABLED && static_cast<std::size_t>(align) <= 64)
+      return allocate(size);
+    return ::operator new(size, align);
+  }
+  static void operator delete(void* p) { deallocate(p); }
+  static void operator delete(void* p, std::align_val_t align) {
+    if (ENABLED && static_cast<std::size_t>(align) <= 64)
+      deallocate(p);
+    else
+      ::operator delete(p, align);
+  }
+};
+
+// Allocator for std containers, e.g. the nodes of a std::set
+template <class T>
+struct Allocator {
+  using value_type = T;
+
+  Allocator() = default;
+  template <class U>
+  Allocator(const Allocator<U>&) {}
+
+  T* allocate(std::size_t n) {
+    if constexpr (alignof(T) > 64)
+      return std::allocator<T>{}.allocate(n);
+    return static_cast<T*>(Numa::allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, std::size_t n) {
+    if constexpr (alignof(T) > 64)
+      std::allocator<T>{}.deallocate(p, n);
+    else
+      Numa::deallocate(p);
+  }
+
+  template <class U>
+  bool operator==(const Allocator<U>&) const {
+    return true;
+  }
+};
+}  // namespace Numa
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#ifdef OP_COUNTERS_ENABLED
+#include <mutex>
+#include <vector>
+#endif
+
+// Hot path counters for the lock-free trees, compiled in with
+// -DOP_COUNTERS_ENABLED (the WITH_OP_COUNTERS CMake option). Every thread
+// bumps its own cache line, collect() sums them on demand. Without the
+// define every call is an empty inline function.
+namespace OpCounters {
+enum Counter : int {
+  CAS,
+  CAS_FAILED,
+  CLEANUP,
+  HELP,
+  HELP_INSERT,
+  HELP_ROTATE,
+  RETRY,
+  SEEK,
+  SEEK_RESTART,
+  SEEK_DEPTH,
+  ROUTED,
+  ROUTE_STALE,
+  NUM_COUNTERS
+};
+
+constexpr const char* NAMES[NUM_COUNTERS] = {
+    "cas",          "cas_failed",  "cleanup", "help",
+    "help_insert",  "help_rotate", "retry",   "seek",
+    "seek_restart", "seek_depth",  "routed",  "route_stale"};
+
+using Totals = std::array<uint64_t, NUM_COUNTERS>;
+
+#ifdef OP_COUNTERS_ENABLED
+constexpr bool ENABLED = true;
+
+struct alignas(64) Block {
+  std::atomic<uint64_t> values[NUM_COUNTERS]{};
+};
+
+// Blocks are handed back when their thread exits and reused by the next
+// one, so the totals survive short lived threads
+struct Registry {
+  std::mutex mut;
+  std::vector<Block*> all, unused;
+};
+
+inline Registry& registry() {
+  static Registry r;
+  return r;
+}
+
+inline Block& localBlock() {
+  struct Owner {
+    Block* block;
+    Owner() {
+      std::lock_guard lk{registry().mut};
+      if (registry().unused.empty()) {
+        block = new Block();
+        registry().all.push_back(block);
+      } else {
+        block = registry().unused.back();
+        registry().unused.pop_back();
+      }
+    }
+    ~Owner() {
+      std::lock_guard lk{registry().mut};
+      registry().unused.push_back(block);
+    }
+  };
+  thread_local Owner owner;
+  return *owner.block;
+}
+
+// Only the owning thread writes its block, a plain increment is enough
+inline void count(Counter c, uint64_t n = 1) {
+  std::atomic<uint64_t>& value = localBlock().values[c];
+  value.store(value.load(std::memory_order_relaxed) + n,
+              std::memory_order_relaxed);
+}
+
+inline Totals collect() {
+  Totals totals{};
+  std::lock_guard lk{registry().mut};
+  for (const Block* block : registry().all) {
+    for (int c = 0; c < NUM_COUNTERS; c++)
+      totals[c] += block->values[c].load(std::memory_order_relaxed);
+  }
+  return totals;
+}
+
+// Racy against threads that are counting, call it between runs
+inline void reset() {
+  std::lock_guard lk{registry().mut};
+  for (Block* block : registry().all) {
+    for (std::atomic<uint64_t>& value : block->values)
+      value.store(0, std::memory_order_relaxed);
+  }
+}
+#else
+constexpr bool ENABLED = false;
+
+inline void count(Counter, uint64_t = 1) {}
+inline Totals collect() {
+  return {};
+}
+inline void reset() {}
+#endif
+
+// Counts a CAS and passes its result through
+inline bool cas(bool succeeded) {
+  count(CAS);
+  if (!succeeded)
+    count(CAS_FAILED);
+  return succeeded;
+}
+}  // namespace OpCounters
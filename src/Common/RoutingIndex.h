@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "src/Common/Epoch.h"
+
+// Read-only copy of the top levels of a search tree, which maps a key to a
+// node further down to start the search for it at. Trees check that the node
+// is still where the index saw it before they use it and search from the
+// root otherwise, so a stale index costs time but is never wrong.
+namespace Routing {
+// Entries are sorted by the smallest key they route, bounds[i] is the
+// smallest key of entries[i + 1]
+template <class T, class Entry>
+struct Index {
+  std::vector<T> bounds;
+  std::vector<Entry> entries;
+  // Some entry is above the levels asked for, the tree was shallower then
+  bool shallow = false;
+
+  void add(const T& low, const Entry& entry) {
+    if (!entries.empty())
+      bounds.push_back(low);
+    entries.push_back(entry);
+  }
+
+  // Position of the entry routing key, an entry routes its smallest key
+  std::size_t find(const T& key) const {
+    return std::upper_bound(bounds.begin(), bounds.end(), key) -
+           bounds.begin();
+  }
+};
+
+// Index a tree publishes for its operations and rebuilds once enough of
+// them found it stale, or made it too shallow. Threads count that on their
+// own, so the count is not shared but spans every tree of the same type.
+// Readers pin the index, replaced ones are freed once no reader can see
+// them any more.
+template <class T, class Entry>
+struct Cache {
+  using Index = Routing::Index<T, Entry>;
+
+  // Stale entries met, or updates to a shallow index, before a rebuild
+  constexpr static uint32_t REBUILD_AFTER = 4096;
+
+  ~Cache() { delete current.load(); }
+
+  // Guards must not be nested, the ones of count() and reset() included
+  auto pin() { return epochs.pin(); }
+
+  // Caller is pinned
+  const Index* load() const {
+    return current.load(std::memory_order_acquire);
+  }
+
+  int levels() const { return depth.load(std::memory_order_relaxed); }
+
+  // build(levels) returns the index over the top levels of the tree, no
+  // index is kept for 0 levels
+  template <class Build>
+  void reset(int levels, Build&& build) {
+    auto guard = pin();
+    std::lock_guard lk{mut};
+    depth.store(levels, std::memory_order_relaxed);
+    publish(levels == 0 ? nullptr : new Index(build(levels)));
+  }
+
+  // Counts a stale entry, or an update if the index is shallow, and rebuilds
+  // the index once the thread counted REBUILD_AFTER of them
+  template <class Build>
+  void count(bool stale, Build&& build) {
+    thread_local uint32_t counted = 0;
+    if (levels() == 0)
+      return;
+    auto guard = pin();
+    const Index* index = load();
+    if (index == nullptr || (!stale && !index->shallow))
+      return;
+    if (++counted < REBUILD_AFTER)
+      return;
+    counted = 0;
+    std::unique_lock lk{mut, std::try_to_lock};
+    if (!lk.owns_lock() || load() != index)
+      return;
+    publish(new Index(build(levels())));
+  }
+
+  // Bytes of the current index and an estimate for the replaced ones not
+  // freed yet, which were about as large
+  std::pair<std::size_t, std::size_t> bytes() {
+    auto guard = pin();
+    const std::size_t currentBytes = bytesOf(load());
+    return {currentBytes, epochs.pending() * currentBytes};
+  }
+
+ private:
+  std::atomic<const Index*> current{nullptr};
+  std::atomic<int> depth{0};
+  std::mutex mut;
+  // An index is large, so every replacement tries to free the old ones
+  Epoch::Manager<const Index, 1> epochs;
+
+  // Caller holds mut and is pinned
+  void publish(const Index* index) {
+    if (const Index* old = current.exchange(index, std::memory_order_acq_rel))
+      epochs.retire(old);
+  }
+
+  static std::size_t bytesOf(const Index* index) {
+    if (index == nullptr)
+      return 0;
+    return sizeof(Index) + index->bounds.capacity() * sizeof(T) +
+           index->entries.capacity() * sizeof(Entry);
+  }
+};
+}  // namespace Routing
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+// Shape of a binary tree, depths count the node a walk starts from as 1.
+// Trees fill it in with a walk that runs next to updates and takes no locks
+// beyond what the tree needs to not crash, so under updates it is a best
+// effort picture: a rotation or removal during the walk can hide or repeat a
+// subtree.
+struct ShapeStats {
+  enum class Kind { KEY, DELETED, ROUTING };
+
+  int height = 0;
+  // leafDepths[d] is the number of leaves at depth d
+  std::vector<std::size_t> leafDepths;
+  std::size_t nodes = 0, keys = 0;
+  // Logically deleted nodes still linked into the tree
+  std::size_t deletedNodes = 0;
+  // Sum of the depths of the nodes holding keys
+  std::size_t keyDepths = 0;
+  // Largest difference between the heights of the two subtrees of a node
+  int maxImbalance = 0;
+
+  std::size_t leaves() const {
+    std::size_t leaves = 0;
+    for (const std::size_t count : leafDepths)
+      leaves += count;
+    return leaves;
+  }
+
+  // Nodes a lookup of a key in the tree visits, on average over the keys
+  double averagePathLength() const {
+    return keys == 0 ? 0.0 : static_cast<double>(keyDepths) / keys;
+  }
+};
+
+// Walks the binary tree under root. Nodes are handles, a pointer or a tagged
+// word, and Node{} stands for no node. children(node) returns the left and
+// right child and kind(node) what the node holds. Iterative, a degenerate
+// tree is as deep as it has nodes.
+template <class Node, class Children, class KindOf>
+ShapeStats shapeOf(Node root, Children&& children, KindOf&& kind) {
+  struct Frame {
+    Node node;
+    int depth;
+    Node left{}, right{};
+    bool expanded = false;
+  };
+
+  ShapeStats stats;
+  if (root == Node{})
+    return stats;
+  std::vector<Frame> stack{{root, 1}};
+  // Heights of finished subtrees, a node finds its children's on top
+  std::vector<int> heights;
+  while (!stack.empty()) {
+    Frame& frame = stack.back();
+    if (frame.expanded) {
+      const int right = frame.right != Node{} ? heights.back() : 0;
+      if (frame.right != Node{})
+        heights.pop_back();
+      const int left = frame.left != Node{} ? heights.back() : 0;
+      if (frame.left != Node{})
+        heights.pop_back();
+      stats.maxImbalance = std::max(stats.maxImbalance, std::abs(left - right));
+      heights.push_back(1 + std::max(left, right));
+      stack.pop_back();
+      continue;
+    }
+
+    frame.expanded = true;
+    const auto [left, right] = children(frame.node);
+    frame.left = left;
+    frame.right = right;
+    const int depth = frame.depth;
+    stats.nodes++;
+    stats.height = std::max(stats.height, depth);
+    switch (kind(frame.node)) {
+      case ShapeStats::Kind::KEY:
+        stats.keys++;
+        stats.keyDepths += depth;
+        break;
+      case ShapeStats::Kind::DELETED:
+        stats.deletedNodes++;
+        break;
+      case ShapeStats::Kind::ROUTING:
+        break;
+    }
+    if (left == Node{} && right == Node{}) {
+      if (stats.leafDepths.size() <= static_cast<std::size_t>(depth))
+        stats.leafDepths.resize(depth + 1);
+      stats.leafDepths[depth]++;
+    }
+    // Frame is invalidated by the pushes, left finishes first
+    if (right != Node{})
+      stack.push_back({right, depth + 1});
+    if (left != Node{})
+      stack.push_back({left, depth + 1});
+  }
+  return stats;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Counter spread over cache lines, so that threads updating it rarely share
+// one. Reading sums every cell and is only exact while no update runs.
+struct ShardedCounter {
+  constexpr static std::size_t CELLS = 32;
+
+  void add(int64_t n) {
+    cells[cell()].value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  int64_t load() const {
+    int64_t sum = 0;
+    for (const Cell& c : cells)
+      sum += c.value.load(std::memory_order_relaxed);
+    return sum;
+  }
+
+ private:
+  struct alignas(64) Cell {
+    std::atomic<int64_t> value{0};
+  };
+
+  Cell cells[CELLS];
+
+  static std::size_t cell() {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t mine = next.fetch_add(1) % CELLS;
+    return mine;
+  }
+};
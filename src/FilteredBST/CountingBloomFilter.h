@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "src/Common/MemoryStats.h"
+
+namespace Filtered {
+constexpr int BLOCK_SIZE = 64;
+
+// Counters of one cache line, every key is hashed to a single block
+struct alignas(BLOCK_SIZE) Block {
+  std::atomic<uint8_t> counters[BLOCK_SIZE]{};
+};
+}  // namespace Filtered
+
+// Blocked counting Bloom filter. A key sets HASHES counters within one cache
+// line, so a lookup reads one line whatever the answer. Counters saturate
+// and then stay put, so the filter never forgets a key, it only gets less
+// selective. Sized for capacity keys at COUNTERS_PER_KEY, past that the
+// false positive rate climbs.
+template <class T, class Hash = std::hash<T>>
+struct CountingBloomFilter {
+  constexpr static int HASHES = 4;
+  constexpr static std::size_t COUNTERS_PER_KEY = 8;
+  constexpr static uint8_t STUCK = 255;
+
+  explicit CountingBloomFilter(std::size_t capacity = std::size_t(1) << 16)
+      : bits{std::max<int>(1, std::bit_width(capacity * COUNTERS_PER_KEY /
+                                             Filtered::BLOCK_SIZE))},
+        blocks{new Filtered::Block[std::size_t(1) << bits]} {}
+
+  // False if key was never added or has been removed as often as added
+  bool mayContain(const T& key) const {
+    const uint64_t h = hash(key);
+    const Filtered::Block& block = blockOf(h);
+    for (int i = 0; i < HASHES; i++) {
+      if (block.counters[slot(h, i)].load() == 0)
+        return false;
+    }
+    return true;
+  }
+
+  void add(const T& key) {
+    const uint64_t h = hash(key);
+    Filtered::Block& block = blockOf(h);
+    for (int i = 0; i < HASHES; i++) {
+      std::atomic<uint8_t>& counter = block.counters[slot(h, i)];
+      uint8_t count = counter.load();
+      while (count != STUCK && !counter.compare_exchange_weak(count, count + 1))
+        ;
+    }
+  }
+
+  // Only for a key that was added and not removed since
+  void remove(const T& key) {
+    const uint64_t h = hash(key);
+    Filtered::Block& block = blockOf(h);
+    for (int i = 0; i < HASHES; i++) {
+      std::atomic<uint8_t>& counter = block.counters[slot(h, i)];
+      uint8_t count = counter.load();
+      while (count != STUCK && !counter.compare_exchange_weak(count, count - 1))
+        ;
+    }
+  }
+
+  MemoryStats memory_stats() const {
+    MemoryStats stats;
+    stats.liveBytes = (std::size_t(1) << bits) * sizeof(Filtered::Block);
+    return stats;
+  }
+
+ private:
+  const int bits;
+  std::unique_ptr<Filtered::Block[]> blocks;
+
+  // Hash spread over all 64 bits, the top ones pick the block and the bottom
+  // ones the counters in it
+  static uint64_t hash(const T& key) {
+    uint64_t h = static_cast<uint64_t>(Hash{}(key));
+    h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDull;
+    h = (h ^ (h >> 33)) * 0xC4CEB9FE1A85EC53ull;
+    return h ^ (h >> 33);
+  }
+
+  static int slot(uint64_t h, int i) {
+    return (h >> (6 * i)) % Filtered::BLOCK_SIZE;
+  }
+
+  Filtered::Block& blockOf(uint64_t h) const {
+    return blocks[h >> (64 - bits)];
+  }
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "CountingBloomFilter.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+
+// Tree with a counting Bloom filter in front of its lookups, a lookup of a
+// key the filter rules out never walks the tree. Inserts add to the filter
+// before the key can be found in the tree and removes take it out after the
+// key is gone, so the filter covers every key in the tree at all times and
+// lookups stay linearizable.
+template <class T, class Tree = NatarajanBST<T>, class Hash = std::hash<T>>
+struct FilteredBST {
+  Tree tree;
+
+  explicit FilteredBST(std::size_t capacity = std::size_t(1) << 16)
+      : filter{capacity} {}
+
+  bool operator[](const T& key) { return filter.mayContain(key) && tree[key]; }
+
+  bool insert(const T& key) {
+    filter.add(key);
+    if (tree.insert(key))
+      return true;
+    filter.remove(key);
+    return false;
+  }
+
+  bool remove(const T& key) {
+    if (!tree.remove(key))
+      return false;
+    filter.remove(key);
+    return true;
+  }
+
+  MemoryStats memory_stats() {
+    MemoryStats stats = tree.memory_stats();
+    stats += filter.memory_stats();
+    return stats;
+  }
+
+  ShapeStats shape_stats() { return tree.shape_stats(); }
+
+ private:
+  CountingBloomFilter<T, Hash> filter;
+};
@@ -3,19 +3,33 @@
 #include <limits>
 #include <mutex>
 #include <utility>
+#include <vector>
 
 #include "FGLBSTNode.h"
+#include "src/Common/LockProfiler.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/ShapeStats.h"
+#include "src/Common/ShardedCounter.h"
 
 template <class T, T inf0 = std::numeric_limits<T>::max() - 1,
           T inf1 = std::numeric_limits<T>::max()>
 struct FGLBST {
+  // Profiled by the depth of the locked node, root is depth 0
+  using ReadLock =
+      LockProfiler::ProfiledLock<std::shared_lock<std::shared_mutex>>;
+  using WriteLock =
+      LockProfiler::ProfiledLock<std::unique_lock<std::shared_mutex>>;
+
   FGLBSTNode<T>* root = new FGLBSTNode<T>(inf1, new FGLBSTNode<T>(inf0));
 
+  FGLBST() { allocatedNodes.add(2); }
+
   ~FGLBST() { cleanup_all(root); }
 
   bool operator[](const T& key) {
-    std::shared_lock<std::shared_mutex> lk{root->mut};
+    ReadLock lk{root->mut, 0};
     FGLBSTNode<T>* curNode = root;
+    uint64_t depth = 0;
     // insert
 
     while (key != curNode->key) {
@@ -23,64 +37,97 @@ struct FGLBST {
         if (curNode->left == nullptr)
           return false;
         curNode = curNode->left;
-        lk = std::shared_lock<std::shared_mutex>{curNode->mut};
+        lk = ReadLock{curNode->mut, LockProfiler::level(++depth)};
       } else {
         if (curNode->right == nullptr)
           return false;
         curNode = curNode->right;
-        lk = std::shared_lock<std::shared_mutex>{curNode->mut};
+        lk = ReadLock{curNode->mut, LockProfiler::level(++depth)};
       }
     }
     return true;
   }
 
+  // Writers descend with shared locks like readers and only lock the nodes
+  // they change exclusively. A node's key and child pointers only change
+  // under its exclusive lock, and a node is only unlinked under its parent's,
+  // so upgrading a lock while the parent stays shared locked only has to
+  // check that the node itself did not change in between.
   bool insert(const T& key) {
-    std::unique_lock<std::shared_mutex> lk{root->mut};
-    FGLBSTNode<T>* cur = root;
-
-    while (cur->key != key) {
-      if (key < cur->key) {
-        if (cur->left == nullptr) {
-          cur->left = new FGLBSTNode<T>(key);
-          return true;
+    while (true) {
+      ReadLock parentLk{root->mut, 0}, lk{root->left->mut, 1};
+      FGLBSTNode<T>* cur = root->left;
+      uint64_t depth = 1;
+
+      while (true) {
+        while (cur->key != key) {
+          FGLBSTNode<T>* next = key < cur->key ? cur->left : cur->right;
+          if (next == nullptr)
+            break;
+          cur = next;
+          parentLk = std::move(lk);
+          lk = ReadLock{cur->mut, LockProfiler::level(++depth)};
         }
-        cur = cur->left;
-        lk = std::unique_lock<std::shared_mutex>{cur->mut};
-      } else {
-        if (cur->right == nullptr) {
-          cur->right = new FGLBSTNode<T>(key);
+        if (cur->key == key)
+          return false;
+
+        const T curKey = cur->key;
+        lk.unlock();
+        WriteLock writeLk{cur->mut, LockProfiler::level(depth)};
+        if (cur->key != curKey)
+          break;
+        FGLBSTNode<T>*& next = key < cur->key ? cur->left : cur->right;
+        if (next == nullptr) {
+          next = new FGLBSTNode<T>(key);
+          allocatedNodes.add(1);
           return true;
         }
-        cur = cur->right;
-        lk = std::unique_lock<std::shared_mutex>{cur->mut};
+
+        // Another insertion took the spot, carry on below it
+        writeLk.unlock();
+        lk = ReadLock{cur->mut, LockProfiler::level(depth)};
+        if (cur->key != curKey)
+          break;
       }
     }
-
-    return false;
   }
 
   bool remove(const T& key) {
-    std::unique_lock<std::shared_mutex> lk{root->mut}, deleteLk;
-    FGLBSTNode<T>*cur = root, *child = root->left;
-
+    WriteLock lk, deleteLk;
+    FGLBSTNode<T>*cur, *child;
+    uint64_t depth;
     while (true) {
-      std::unique_lock<std::shared_mutex> childLk{child->mut};
-      if (child->key == key) {
-        deleteLk = std::move(childLk);
-        break;
-      } else if (key < child->key) {
-        if (child->left == nullptr)
-          return false;
-        cur = child;
-        child = child->left;
-        lk = std::move(childLk);
-      } else {
-        if (child->right == nullptr)
+      // Shared locks on child, its parent cur and grandparent
+      ReadLock grandparentLk{root->mut, 0}, parentLk{root->left->mut, 1},
+          childLk;
+      cur = root->left;
+      child = cur->left;
+      depth = 2;
+      if (child == nullptr)
+        return false;
+      childLk = ReadLock{child->mut, LockProfiler::level(depth)};
+
+      while (child->key != key) {
+        FGLBSTNode<T>* next = key < child->key ? child->left : child->right;
+        if (next == nullptr)
           return false;
         cur = child;
-        child = child->right;
-        lk = std::move(childLk);
+        child = next;
+        grandparentLk = std::move(parentLk);
+        parentLk = std::move(childLk);
+        childLk = ReadLock{child->mut, LockProfiler::level(++depth)};
+      }
+
+      childLk.unlock();
+      parentLk.unlock();
+      lk = WriteLock{cur->mut, LockProfiler::level(depth - 1)};
+      if (cur->left == child || cur->right == child) {
+        deleteLk = WriteLock{child->mut, LockProfiler::level(depth)};
+        if (child->key == key)
+          break;
+        deleteLk.unlock();
       }
+      lk.unlock();
     }
 
     // Three Cases:
@@ -98,15 +145,16 @@ struct FGLBST {
     }
 
     // 3. There must be 2 children
-    std::unique_lock<std::shared_mutex> inorderParentLk,
-        inorderSuccessorLk{child->left->mut};
+    WriteLock inorderParentLk,
+        inorderSuccessorLk{child->left->mut, LockProfiler::level(++depth)};
     FGLBSTNode<T>** inorderSuccessorPtr = &(child->left);
     FGLBSTNode<T>* inorderSuccessor = child->left;
     while (inorderSuccessor->right != nullptr) {
       inorderSuccessorPtr = &(inorderSuccessor->right);
       inorderSuccessor = inorderSuccessor->right;
 
-      std::unique_lock<std::shared_mutex> grandChildLk{inorderSuccessor->mut};
+      WriteLock grandChildLk{inorderSuccessor->mut,
+                             LockProfiler::level(++depth)};
       inorderParentLk = std::move(inorderSuccessorLk);
       inorderSuccessorLk = std::move(grandChildLk);
     }
@@ -116,6 +164,42 @@ struct FGLBST {
     return true;
   }
 
+  // Removed nodes are never freed, they show up as retired. Each node is
+  // read under its shared lock, the walk is exact while no update runs.
+  MemoryStats memory_stats() {
+    MemoryStats stats;
+    std::vector<FGLBSTNode<T>*> stack{root};
+    while (!stack.empty()) {
+      FGLBSTNode<T>* node = stack.back();
+      stack.pop_back();
+      stats.liveNodes++;
+      const auto [left, right] = children(node);
+      if (left != nullptr)
+        stack.push_back(left);
+      if (right != nullptr)
+        stack.push_back(right);
+    }
+    stats.keys = stats.liveNodes - 2;  // sentinels
+    stats.liveBytes = stats.liveNodes * sizeof(FGLBSTNode<T>);
+    // Inserts count their nodes after linking them, a walk next to them may
+    // see more
+    const int64_t retired = allocatedNodes.load() - stats.liveNodes;
+    stats.retiredNodes = retired > 0 ? retired : 0;
+    stats.retiredBytes = stats.retiredNodes * sizeof(FGLBSTNode<T>);
+    return stats;
+  }
+
+  // Walked from the root, sentinels included. Nodes are read under their
+  // shared locks one at a time and never freed, so it is safe but
+  // approximate next to updates.
+  ShapeStats shape_stats() {
+    return shapeOf(root, children, [](FGLBSTNode<T>* node) {
+      std::shared_lock lk{node->mut};
+      return node->key < inf0 ? ShapeStats::Kind::KEY
+                              : ShapeStats::Kind::ROUTING;
+    });
+  }
+
   void cleanup_all(FGLBSTNode<T>* node) {
     if (node == nullptr)
       return;
@@ -123,4 +207,13 @@ struct FGLBST {
     cleanup_all(node->right);
     delete node;
   }
+
+ private:
+  ShardedCounter allocatedNodes;
+
+  static std::pair<FGLBSTNode<T>*, FGLBSTNode<T>*> children(
+      FGLBSTNode<T>* node) {
+    std::shared_lock lk{node->mut};
+    return {node->left, node->right};
+  }
 };
\ No newline at end of file
@@ -4,8 +4,10 @@
 #include <mutex>
 #include <shared_mutex>
 
+#include "src/Common/NumaAllocator.h"
+
 template <class T>
-struct FGLBSTNode {
+struct FGLBSTNode : Numa::Allocated {
   T key;
   std::shared_mutex mut;
   FGLBSTNode<T>*left, *right;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/CoarseGrainedLockingBST/CGLBST.h"
+#include "src/Common/Epoch.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/ShapeStats.h"
+
+namespace FlatCombining {
+enum class Op : uint8_t { INSERT, REMOVE };
+
+template <class T>
+struct alignas(64) Slot {
+  std::atomic<bool> pending{false};
+  Op op{};
+  T key{};
+  bool result{};
+};
+}  // namespace FlatCombining
+
+// Flat combining over a lock-based tree. Updaters publish their operation in
+// a slot of their own and whichever of them gets the combiner lock applies
+// every pending one in key order, so the tree stays in one core's cache
+// instead of moving with its lock. Lookups go to the tree directly.
+template <class T, class Tree = CGLBST<T>>
+struct FlatCombiningBST {
+  Tree tree;
+
+  bool operator[](const T& key) { return tree[key]; }
+
+  bool insert(const T& key) { return apply(FlatCombining::Op::INSERT, key); }
+
+  bool remove(const T& key) { return apply(FlatCombining::Op::REMOVE, key); }
+
+  MemoryStats memory_stats() {
+    MemoryStats stats = tree.memory_stats();
+    stats.descriptorBytes += sizeof(slots);
+    return stats;
+  }
+
+  ShapeStats shape_stats() { return tree.shape_stats(); }
+
+ private:
+  std::mutex combiner;
+  // One past the highest slot ever published in
+  std::atomic<std::size_t> usedSlots{0};
+  // Indexed by Epoch::threadSlot()
+  FlatCombining::Slot<T> slots[Epoch::MAX_THREADS];
+  // Guarded by combiner
+  std::vector<FlatCombining::Slot<T>*> batch;
+
+  bool apply(FlatCombining::Op op, const T& key) {
+    const std::size_t index = Epoch::threadSlot();
+    std::size_t used = usedSlots.load();
+    while (used <= index && !usedSlots.compare_exchange_weak(used, index + 1))
+      ;
+
+    FlatCombining::Slot<T>& slot = slots[index];
+    slot.op = op;
+    slot.key = key;
+    slot.pending.store(true, std::memory_order_release);
+    while (slot.pending.load(std::memory_order_acquire)) {
+      if (combiner.try_lock()) {
+        combine();
+        combiner.unlock();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    return slot.result;
+  }
+
+  void combine() {
+    batch.clear();
+    for (std::size_t i = 0, e = usedSlots.load(); i < e; i++) {
+      if (slots[i].pending.load(std::memory_order_acquire))
+        batch.push_back(&slots[i]);
+    }
+    std::sort(batch.begin(), batch.end(),
+              [](const FlatCombining::Slot<T>* a,
+                 const FlatCombining::Slot<T>* b) { return a->key < b->key; });
+    for (FlatCombining::Slot<T>* slot : batch) {
+      slot->result = run(slot->op, slot->key);
+      slot->pending.store(false, std::memory_order_release);
+    }
+  }
+
+  bool run(FlatCombining::Op op, const T& key) {
+    return op == FlatCombining::Op::INSERT ? tree.insert(key)
+                                           : tree.remove(key);
+  }
+};
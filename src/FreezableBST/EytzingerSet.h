@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "src/Common/MemoryStats.h"
+#include "src/Common/NumaAllocator.h"
+#include "src/Common/ShapeStats.h"
+
+// Read-only set in Eytzinger layout, a complete binary search tree stored in
+// breadth first order. keys[0] is unused, the children of keys[i] are
+// keys[2i] and keys[2i + 1], so the first levels every lookup reads share a
+// few cache lines and the rest of the path is prefetched ahead of it.
+template <class T>
+struct EytzingerSet {
+  // Keys per cache line. The descendants of a node log2(KEYS_PER_LINE)
+  // levels down are next to each other, a lookup prefetches their line while
+  // it walks towards them.
+  constexpr static std::size_t KEYS_PER_LINE =
+      std::max<std::size_t>(1, 64 / sizeof(T));
+
+  // Sorted and without duplicates
+  explicit EytzingerSet(const std::vector<T>& sorted)
+      : keys(sorted.size() + 1) {
+    fill(sorted, 0, 1);
+  }
+
+  // The comparison only picks the next index, so the loop has no branch
+  // besides its bound and runs the same number of times for every key
+  bool operator[](const T& key) const {
+    const T* base = keys.data();
+    const std::size_t n = size();
+    std::size_t i = 1;
+    while (i <= n) {
+      __builtin_prefetch(base + std::min(i * KEYS_PER_LINE, n));
+      i = 2 * i + (base[i] < key);
+    }
+    // Undo the right turns after the last left one, which was at the
+    // smallest key not below key
+    i >>= std::countr_one(i) + 1;
+    return i != 0 && base[i] == key;
+  }
+
+  std::size_t size() const { return keys.size() - 1; }
+
+  // Calls f with every key, parents before their children. Inserting them in
+  // that order builds a balanced binary search tree.
+  template <class F>
+  void for_each_level_order(F&& f) const {
+    for (std::size_t i = 1; i < keys.size(); i++)
+      f(keys[i]);
+  }
+
+  MemoryStats memory_stats() const {
+    MemoryStats stats;
+    stats.keys = size();
+    stats.liveNodes = 1;
+    stats.liveBytes = sizeof(*this) + keys.capacity() * sizeof(T);
+    return stats;
+  }
+
+  ShapeStats shape_stats() const {
+    const std::size_t n = size();
+    return shapeOf(
+        std::min<std::size_t>(n, 1),
+        [n](std::size_t i) {
+          return std::pair{2 * i <= n ? 2 * i : 0,
+                           2 * i + 1 <= n ? 2 * i + 1 : 0};
+        },
+        [](std::size_t) { return ShapeStats::Kind::KEY; });
+  }
+
+ private:
+  std::vector<T, Numa::Allocator<T>> keys;
+
+  // In-order walk of the implicit tree under i, takes keys from sorted[next]
+  // on and returns the index after the last one taken
+  std::size_t fill(const std::vector<T>& sorted, std::size_t next,
+                   std::size_t i) {
+    if (i >= keys.size())
+      return next;
+    next = fill(sorted, next, 2 * i);
+    keys[i] = sorted[next++];
+    return fill(sorted, next, 2 * i + 1);
+  }
+};
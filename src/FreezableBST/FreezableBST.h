@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+
+#include "EytzingerSet.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/ShapeStats.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+
+// Tree that can be frozen into an EytzingerSet once it is only read, and
+// thawed back into a Tree before it is updated again. Tree has to list its
+// keys with for_each. freeze() and thaw() must not run next to any other
+// operation. Updates fail while frozen, the tree has to be thawed first.
+template <class T, class Tree = NatarajanBST<T>>
+struct FreezableBST {
+  FreezableBST() : tree{new Tree()} {}
+  FreezableBST(const FreezableBST&) = delete;
+  ~FreezableBST() {
+    delete tree;
+    delete frozen;
+  }
+
+  bool operator[](const T& key) {
+    return frozen != nullptr ? (*frozen)[key] : (*tree)[key];
+  }
+
+  bool insert(const T& key) {
+    if (frozen != nullptr)
+      return false;
+    return tree->insert(key);
+  }
+
+  bool remove(const T& key) {
+    if (frozen != nullptr)
+      return false;
+    return tree->remove(key);
+  }
+
+  // Frees the tree, its keys are only kept in the frozen set
+  void freeze() {
+    if (frozen != nullptr)
+      return;
+    std::vector<T> keys;
+    tree->for_each([&keys](const T& key) { keys.push_back(key); });
+    frozen = new EytzingerSet<T>(keys);
+    delete tree;
+    tree = nullptr;
+  }
+
+  // Keys go back in level order of the frozen set, so a tree that does not
+  // balance itself comes back balanced
+  void thaw() {
+    if (frozen == nullptr)
+      return;
+    tree = new Tree();
+    frozen->for_each_level_order([this](const T& key) { tree->insert(key); });
+    delete frozen;
+    frozen = nullptr;
+  }
+
+  bool is_frozen() const { return frozen != nullptr; }
+
+  MemoryStats memory_stats() {
+    return frozen != nullptr ? frozen->memory_stats() : tree->memory_stats();
+  }
+
+  ShapeStats shape_stats() {
+    if (frozen != nullptr)
+      return frozen->shape_stats();
+    if constexpr (requires { tree->shape_stats(); })
+      return tree->shape_stats();
+    return ShapeStats{};
+  }
+
+ private:
+  // Exactly one of them is set
+  Tree* tree;
+  EytzingerSet<T>* frozen = nullptr;
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "src/Common/Epoch.h"
+#include "src/Common/MemoryStats.h"
+
+namespace HashIndexed {
+template <class T>
+struct Entry {
+  const T key;
+  std::atomic<Entry<T>*> next;
+
+  Entry(const T& key, Entry<T>* next) : key{key}, next{next} {}
+};
+
+template <class T>
+struct Table {
+  const int bits;
+  std::vector<std::atomic<Entry<T>*>> buckets;
+
+  explicit Table(int bits) : bits{bits}, buckets(std::size_t(1) << bits) {}
+
+  // Entries are copied into a new table when it grows, each table owns the
+  // ones linked in it
+  ~Table() {
+    for (std::atomic<Entry<T>*>& head : buckets) {
+      for (Entry<T>* entry = head.load(); entry != nullptr;) {
+        Entry<T>* next = entry->next.load();
+        delete entry;
+        entry = next;
+      }
+    }
+  }
+};
+
+// Writers of one bucket are serialised through its stripe, a stripe covers
+// the same buckets at every table size
+template <class T>
+struct alignas(64) Stripe {
+  std::mutex mut;
+  std::size_t count{0};
+};
+}  // namespace HashIndexed
+
+// Chained hash set whose lookups never lock, they only announce their epoch
+// in a slot of their own. Updates
+// must hold the stripe of their key, which lets the caller pair them with
+// another structure atomically. Unlinked entries and old tables may still be
+// read by lookups, which pin them, so they are freed through epochs.
+template <class T, class Hash = std::hash<T>>
+struct HashIndex {
+  constexpr static int STRIPE_BITS = 8;
+  constexpr static std::size_t STRIPES = std::size_t(1) << STRIPE_BITS;
+  constexpr static std::size_t MAX_LOAD = 2;
+
+  explicit HashIndex(std::size_t capacity = std::size_t(1) << 16)
+      : table{new HashIndexed::Table<T>(std::max<int>(
+            STRIPE_BITS, std::bit_width(capacity / MAX_LOAD)))} {}
+
+  ~HashIndex() { delete table.load(); }
+
+  bool contains(const T& key) {
+    auto guard = pin();
+    const uint64_t h = hash(key);
+    HashIndexed::Table<T>* t = table.load(std::memory_order_acquire);
+    for (HashIndexed::Entry<T>* entry = bucket(t, h).load(); entry != nullptr;
+         entry = entry->next.load()) {
+      if (entry->key == key)
+        return true;
+    }
+    return false;
+  }
+
+  std::mutex& lockFor(const T& key) { return stripeOf(hash(key)).mut; }
+
+  // Caller holds lockFor(key) and knows key is absent. Returns true once the
+  // stripe is overloaded, the caller should then call grow without the lock.
+  bool insert(const T& key) {
+    const uint64_t h = hash(key);
+    HashIndexed::Table<T>* t = table.load();
+    std::atomic<HashIndexed::Entry<T>*>& head = bucket(t, h);
+    head.store(new HashIndexed::Entry<T>(key, head.load()));
+
+    HashIndexed::Stripe<T>& stripe = stripeOf(h);
+    stripe.count++;
+    return stripe.count > (t->buckets.size() / STRIPES) * MAX_LOAD;
+  }
+
+  // Caller holds lockFor(key) and knows key is present
+  void remove(const T& key) {
+    const uint64_t h = hash(key);
+    std::atomic<HashIndexed::Entry<T>*>* link = &bucket(table.load(), h);
+    HashIndexed::Entry<T>* entry = link->load();
+    while (entry->key != key) {
+      link = &entry->next;
+      entry = link->load();
+    }
+    link->store(entry->next.load());
+    stripeOf(h).count--;
+    auto guard = entries.pin();
+    entries.retire(entry);
+  }
+
+  // Doubles the table while holding every stripe
+  void grow() {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(STRIPES);
+    for (HashIndexed::Stripe<T>& stripe : stripes)
+      locks.emplace_back(stripe.mut);
+
+    HashIndexed::Table<T>* old = table.load();
+    std::size_t maxCount = 0;
+    for (const HashIndexed::Stripe<T>& stripe : stripes)
+      maxCount = std::max(maxCount, stripe.count);
+    if (maxCount <= (old->buckets.size() / STRIPES) * MAX_LOAD)
+      return;  // someone else grew it already
+
+    auto* bigger = new HashIndexed::Table<T>(old->bits + 1);
+    for (std::atomic<HashIndexed::Entry<T>*>& head : old->buckets) {
+      for (HashIndexed::Entry<T>* entry = head.load(); entry != nullptr;
+           entry = entry->next.load()) {
+        std::atomic<HashIndexed::Entry<T>*>& newHead =
+            bucket(bigger, hash(entry->key));
+        newHead.store(new HashIndexed::Entry<T>(entry->key, newHead.load()));
+      }
+    }
+    table.store(bigger, std::memory_order_release);
+    auto guard = tables.pin();
+    tables.retire(old);
+  }
+
+  // Keys are left to the tree the index belongs to. Takes no locks, so it is
+  // only exact while no update runs. A retired table held about the entries
+  // of the current one in half its buckets.
+  MemoryStats memory_stats() {
+    auto guard = pin();
+    MemoryStats stats;
+    HashIndexed::Table<T>* t = table.load(std::memory_order_acquire);
+    const std::size_t bytes = tableBytes(t, stats.liveNodes);
+    stats.liveBytes = sizeof(stripes) + bytes;
+    const std::size_t oldBytes =
+        bytes - t->buckets.size() / 2 * sizeof(t->buckets[0]);
+    stats.retiredNodes = entries.pending() + tables.pending() * stats.liveNodes;
+    stats.retiredBytes = entries.pending() * sizeof(HashIndexed::Entry<T>) +
+                         tables.pending() * oldBytes;
+    return stats;
+  }
+
+ private:
+  std::atomic<HashIndexed::Table<T>*> table;
+  HashIndexed::Stripe<T> stripes[STRIPES];
+  Epoch::Manager<HashIndexed::Entry<T>> entries{};
+  Epoch::Manager<HashIndexed::Table<T>, 1> tables{};
+
+  struct Pinned {
+    typename Epoch::Manager<HashIndexed::Entry<T>>::Guard entries;
+    typename Epoch::Manager<HashIndexed::Table<T>, 1>::Guard tables;
+  };
+
+  Pinned pin() { return Pinned{entries.pin(), tables.pin()}; }
+
+  // Fibonacci hashing, the top bits pick the bucket and the stripe
+  static uint64_t hash(const T& key) {
+    return static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+  }
+
+  static std::atomic<HashIndexed::Entry<T>*>& bucket(HashIndexed::Table<T>* t,
+                                                     uint64_t h) {
+    return t->buckets[h >> (64 - t->bits)];
+  }
+
+  HashIndexed::Stripe<T>& stripeOf(uint64_t h) {
+    return stripes[h >> (64 - STRIPE_BITS)];
+  }
+
+  static std::size_t tableBytes(HashIndexed::Table<T>* t, std::size_t& count) {
+    std::size_t bytes = sizeof(*t) + t->buckets.size() * sizeof(t->buckets[0]);
+    for (std::atomic<HashIndexed::Entry<T>*>& head : t->buckets) {
+      for (HashIndexed::Entry<T>* entry = head.load(); entry != nullptr;
+           entry = entry->next.load()) {
+        count++;
+        bytes += sizeof(*entry);
+      }
+    }
+    return bytes;
+  }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+#include "HashIndex.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+
+// Ordered tree paired with a hash index of its keys. Point lookups only probe
+// the index, ordered operations go to the tree directly. Updates of a key are
+// serialised on its index stripe so that both structures agree once the
+// update returns, which makes every update pay for two writes. Only lookups
+// are lock-free. An insert and a remove of the same key each write the tree
+// and the index, and a CAS on either one cannot order those writes against
+// each other. Growing the index holds every stripe, which stalls updates but
+// not lookups.
+template <class T, class Tree = NatarajanBST<T>, class Hash = std::hash<T>>
+struct HashIndexedBST {
+  Tree tree;
+
+  explicit HashIndexedBST(std::size_t capacity = std::size_t(1) << 16)
+      : index{capacity} {}
+
+  bool operator[](const T& key) { return index.contains(key); }
+
+  bool insert(const T& key) {
+    bool overloaded;
+    {
+      std::lock_guard lk{index.lockFor(key)};
+      if (!tree.insert(key))
+        return false;
+      overloaded = index.insert(key);
+    }
+    if (overloaded)
+      index.grow();
+    return true;
+  }
+
+  bool remove(const T& key) {
+    std::lock_guard lk{index.lockFor(key)};
+    if (!tree.remove(key))
+      return false;
+    index.remove(key);
+    return true;
+  }
+
+  MemoryStats memory_stats() {
+    MemoryStats stats = tree.memory_stats();
+    stats += index.memory_stats();
+    return stats;
+  }
+
+  ShapeStats shape_stats() { return tree.shape_stats(); }
+
+ private:
+  HashIndex<T, Hash> index;
+};
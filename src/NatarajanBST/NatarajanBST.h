@@ -1,10 +1,20 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <limits>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
 
 #include "Node.h"
 #include "SeekRecord.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/OpCounters.h"
+#include "src/Common/RoutingIndex.h"
+#include "src/Common/ShapeStats.h"
+#include "src/Common/ShardedCounter.h"
 
 template <class T, T inf0 = std::numeric_limits<T>::max() - 2,
           T inf1 = std::numeric_limits<T>::max() - 1,
@@ -16,6 +26,7 @@ struct NatarajanBST {
   NatarajanBST() {
     auto* S = new Node<T>(inf1, new Node<T>(inf0), new Node<T>(inf1));
     root = new Node<T>(inf2, S, new Node<T>(inf2));
+    allocatedNodes.add(5);
   }
 
   ~NatarajanBST() { cleanup_all(root); }
@@ -30,7 +41,8 @@ struct NatarajanBST {
     assert((reinterpret_cast<uintptr_t>(newLeaf) & Node<T>::FLAG_MASK) == 0);
     assert((reinterpret_cast<uintptr_t>(newLeaf) & Node<T>::FLAG_MASK) == 0);
 
-    while (true) {
+    for (bool retry = false;; retry = true) {
+      OpCounters::count(OpCounters::RETRY, retry);
       SeekRecord<T> s = seek(key);
       // key already in tree
       if (s.leaf->key == key) {
@@ -55,8 +67,12 @@ struct NatarajanBST {
       uintptr_t expected = getPointerUintRepr(leaf),
                 desired = getPointerUintRepr(newInternal);
 
-      if (childAddr->compare_exchange_strong(expected, desired))
+      if (OpCounters::cas(
+              childAddr->compare_exchange_strong(expected, desired))) {
+        allocatedNodes.add(2);
+        countRouting(false);
         return true;
+      }
 
       const auto c = childAddr->load();
       if (getPointer<T>(c) == leaf && getFlags<T>(c) != 0) {
@@ -67,47 +83,129 @@ struct NatarajanBST {
   }
 
   bool remove(const T& key) {
-    DeleteMode mode = DeleteMode::INJECTION;
-    Node<T>* leaf;
-    while (true) {
+    for (bool retry = false;; retry = true) {
+      OpCounters::count(OpCounters::RETRY, retry);
       SeekRecord<T> s = seek(key);
-      std::atomic<uintptr_t>* childAddr =
-          key < s.parent->key ? &(s.parent->left) : &(s.parent->right);
-      if (mode == DeleteMode::INJECTION) {
-        leaf = s.leaf;
-        if (leaf->key != key)
-          return false;
-        uintptr_t expected = getPointerUintRepr<T>(leaf),
-                  desired = expected | Node<T>::FLAG_MASK;
-        if (childAddr->compare_exchange_strong(expected, desired)) {
-          mode = DeleteMode::CLEANUP;
-          if (cleanup(key, s)) {
-            return true;
-          }
-        } else {
-          uintptr_t childData = childAddr->load();
-          if (getPointer<T>(childData) == leaf && getFlags<T>(childData) != 0)
-            cleanup(key, s);
-        }
-      } else {
-        if (s.leaf != leaf || cleanup(key, s))
-          return true;
+      if (s.leaf->key != key)
+        return false;
+      if (inject(key, s)) {
+        unlink(key, s);
+        return true;
+      }
+    }
+  }
+
+  // Removes and returns the smallest key, nothing if the tree is empty. The
+  // key is the smallest in the tree unless inserts run next to pops, whose
+  // keys may be passed over. With spray > 0 the key is picked at random among
+  // about the 2^spray smallest, so threads popping together mostly remove
+  // different keys. With spray 0 no key is passed over here either, a search
+  // for the lowest key ends at the leftmost leaf and any smaller key would
+  // have to be inserted at its edge.
+  std::optional<T> try_pop_min(int spray = 0) { return pop(false, spray); }
+
+  // Removes and returns the largest key, as try_pop_min. Once the largest key
+  // is removed its parent goes, and larger keys may then be inserted at the
+  // edge to the inf0 leaf instead of the one flagged here.
+  std::optional<T> try_pop_max(int spray = 0) { return pop(true, spray); }
+
+  // Unlinked nodes are never freed, they show up as retired
+  MemoryStats memory_stats() {
+    MemoryStats stats;
+    std::vector<Node<T>*> stack{root};
+    while (!stack.empty()) {
+      Node<T>* node = stack.back();
+      stack.pop_back();
+      stats.liveNodes++;
+      Node<T>* left = getPointer<T>(node->left.load());
+      if (left == nullptr) {
+        stats.keys += node->key < inf0;
+        continue;
+      }
+      stack.push_back(left);
+      stack.push_back(getPointer<T>(node->right.load()));
+    }
+    stats.liveBytes = stats.liveNodes * sizeof(Node<T>);
+    // Inserts count their nodes after linking them, a walk next to them may
+    // see more
+    const int64_t retired = allocatedNodes.load() - stats.liveNodes;
+    stats.retiredNodes = retired > 0 ? retired : 0;
+    stats.retiredBytes = stats.retiredNodes * sizeof(Node<T>);
+    const auto [current, replaced] = routing.bytes();
+    stats.descriptorBytes = current + replaced;
+    return stats;
+  }
+
+  // Walked from the root, sentinels included. Nodes are never freed, so it
+  // can run next to updates. Keys live in the leaves, internal nodes only
+  // route.
+  ShapeStats shape_stats() {
+    return shapeOf(
+        root,
+        [](Node<T>* node) {
+          return std::pair{getPointer<T>(node->left.load()),
+                           getPointer<T>(node->right.load())};
+        },
+        [](Node<T>* node) {
+          return node->left.load() == 0 && node->key < inf0
+                     ? ShapeStats::Kind::KEY
+                     : ShapeStats::Kind::ROUTING;
+        });
+  }
+
+  // Nodes on the longest path from the root, sentinels included
+  int height() { return shape_stats().height; }
+
+  // Searches start from an index over the top levels of the tree below S,
+  // which is rebuilt as it goes stale, 0 levels turn it off. An entry is used
+  // while its node is still the child of its parent and neither of the
+  // parent's edges is marked, because a node is only unlinked once one of its
+  // edges is marked, and the keys routed through a linked node only grow.
+  void set_routing_levels(int levels) {
+    routing.reset(levels, [this](int levels) { return routingIndex(levels); });
+  }
+
+  // Calls f with every key in ascending order, only exact while no update
+  // runs
+  template <class F>
+  void for_each(F&& f) {
+    std::vector<Node<T>*> stack{root};
+    while (!stack.empty()) {
+      Node<T>* node = stack.back();
+      stack.pop_back();
+      Node<T>* left = getPointer<T>(node->left.load());
+      if (left == nullptr) {
+        if (node->key < inf0)
+          f(node->key);
+        continue;
       }
+      stack.push_back(getPointer<T>(node->right.load()));
+      stack.push_back(left);
     }
   }
 
  private:
-  enum class DeleteMode { INJECTION, CLEANUP };
+  // Internal node a search can start at, below the untagged edge from parent
+  struct RoutingEntry {
+    Node<T>*parent, *node;
+  };
+
+  ShardedCounter allocatedNodes;
+  Routing::Cache<T, RoutingEntry> routing;
 
   SeekRecord<T> seek(const T& key) {
     SeekRecord<T> s;
-    s.ancestor = root;
-    s.successor = reinterpret_cast<Node<T>*>(root->left.load());
+    const RoutingEntry start = route(key);
+    s.ancestor = start.parent;
+    s.successor = start.node;
     s.parent = s.successor;
-    s.leaf = getPointer<T>(s.successor->left.load());
 
-    uintptr_t parentField = s.parent->left.load(),
-              currentField = s.leaf->left.load();
+    uintptr_t parentField = key < s.parent->key ? s.parent->left.load()
+                                                : s.parent->right.load();
+    s.leaf = getPointer<T>(parentField);
+    uintptr_t currentField =
+        key < s.leaf->key ? s.leaf->left.load() : s.leaf->right.load();
+    uint64_t depth = 0;
 
     // Assumption: nullptr will be 0, use NULL?
     for (Node<T>* current = getPointer<T>(currentField); current != nullptr;
@@ -124,12 +222,172 @@ struct NatarajanBST {
         currentField = current->left.load();
       else
         currentField = current->right.load();
+      depth++;
     }
 
+    OpCounters::count(OpCounters::SEEK);
+    OpCounters::count(OpCounters::SEEK_DEPTH, depth);
     return s;
   }
 
+  // Entry of key in the routing index if it is still valid, S below the
+  // root otherwise
+  RoutingEntry route(const T& key) {
+    const RoutingEntry fromRoot{root, getPointer<T>(root->left.load())};
+    if (routing.levels() == 0)
+      return fromRoot;
+
+    {
+      auto guard = routing.pin();
+      const auto* index = routing.load();
+      if (index == nullptr)
+        return fromRoot;
+
+      const RoutingEntry& entry = index->entries[index->find(key)];
+      const uintptr_t left = entry.parent->left.load(),
+                      right = entry.parent->right.load();
+      if (getFlags<T>(left) == 0 && getFlags<T>(right) == 0 &&
+          (key < entry.parent->key ? left : right) ==
+              getPointerUintRepr(entry.node)) {
+        OpCounters::count(OpCounters::ROUTED);
+        return entry;
+      }
+    }
+    // Unpinned, counting may rebuild the index
+    OpCounters::count(OpCounters::ROUTE_STALE);
+    countRouting(true);
+    return fromRoot;
+  }
+
+  void countRouting(bool stale) {
+    routing.count(stale, [this](int levels) { return routingIndex(levels); });
+  }
+
+  // Internal nodes levels below S, or the ones above them with a leaf as a
+  // child, in key order
+  Routing::Index<T, RoutingEntry> routingIndex(int levels) {
+    struct Frame {
+      RoutingEntry entry;
+      T low;
+      int depth;
+    };
+
+    Routing::Index<T, RoutingEntry> index;
+    // The smallest key of the first entry is never compared against
+    std::vector<Frame> stack{
+        {{root, getPointer<T>(root->left.load())}, T{}, 0}};
+    while (!stack.empty()) {
+      const Frame frame = stack.back();
+      stack.pop_back();
+      Node<T>* node = frame.entry.node;
+      Node<T>*left = getPointer<T>(node->left.load()),
+      *right = getPointer<T>(node->right.load());
+      const bool leafBelow =
+          left->left.load() == 0 || right->left.load() == 0;
+      if (frame.depth == levels || leafBelow) {
+        index.shallow |= frame.depth < levels;
+        index.add(frame.low, frame.entry);
+        continue;
+      }
+      stack.push_back({{node, right}, node->key, frame.depth + 1});
+      stack.push_back({{node, left}, frame.low, frame.depth + 1});
+    }
+    return index;
+  }
+
+  // Flags the edge to s.leaf, or helps the removal that flagged it first
+  bool inject(const T& key, const SeekRecord<T>& s) {
+    std::atomic<uintptr_t>* childAddr =
+        key < s.parent->key ? &(s.parent->left) : &(s.parent->right);
+    uintptr_t expected = getPointerUintRepr<T>(s.leaf),
+              desired = expected | Node<T>::FLAG_MASK;
+    if (OpCounters::cas(childAddr->compare_exchange_strong(expected, desired)))
+      return true;
+    uintptr_t childData = childAddr->load();
+    if (getPointer<T>(childData) == s.leaf && getFlags<T>(childData) != 0)
+      cleanup(key, s);
+    return false;
+  }
+
+  // Unlinks the leaf this thread flagged, unless another thread helped
+  void unlink(const T& key, SeekRecord<T> s) {
+    Node<T>* leaf = s.leaf;
+    while (!cleanup(key, s)) {
+      OpCounters::count(OpCounters::RETRY);
+      s = seek(key);
+      if (s.leaf != leaf)
+        return;
+    }
+  }
+
+  std::optional<T> pop(bool max, int spray) {
+    for (bool retry = false;; retry = true) {
+      OpCounters::count(OpCounters::RETRY, retry);
+      SeekRecord<T> s;
+      if (!max && spray == 0) {
+        s = seek(std::numeric_limits<T>::lowest());
+        if (s.leaf->key >= inf0)
+          return std::nullopt;
+      } else {
+        Node<T>* leaf = pick(max, spray);
+        if (leaf == nullptr)
+          return std::nullopt;
+        s = seek(leaf->key);
+        if (s.leaf != leaf)
+          continue;
+      }
+      const T key = s.leaf->key;
+      if (inject(key, s)) {
+        unlink(key, s);
+        return key;
+      }
+    }
+  }
+
+  // Leaf holding the smallest or largest key, or one below the node spray
+  // levels above it reached by random turns. nullptr if the tree is empty.
+  Node<T>* pick(bool max, int spray) {
+    thread_local std::minstd_rand gen{std::random_device{}()};
+    Node<T>* top = getPointer<T>(getPointer<T>(root->left.load())->left.load());
+    Node<T>* node = top;
+    if (spray > 0) {
+      // The inf0 leaf is the rightmost below top, the largest key is next to
+      // it
+      std::vector<Node<T>*> spine;
+      for (Node<T>* next = node; next->left.load() != 0;
+           next = getPointer<T>(max ? next->right.load() : next->left.load()))
+        spine.push_back(next);
+      if (!spine.empty())
+        node = spine[spine.size() - std::min<std::size_t>(spray, spine.size())];
+      for (int i = 0; i < spray && node->left.load() != 0; i++)
+        node = getPointer<T>(gen() & 1 ? node->right.load()
+                                       : node->left.load());
+    }
+    Node<T>* leaf = firstLeaf(node, max);
+    return leaf != nullptr || node == top ? leaf : firstLeaf(top, max);
+  }
+
+  // Leftmost leaf below node holding a key, or the rightmost one for max
+  Node<T>* firstLeaf(Node<T>* node, bool max) {
+    std::vector<Node<T>*> stack{node};
+    while (!stack.empty()) {
+      node = stack.back();
+      stack.pop_back();
+      Node<T>* left = getPointer<T>(node->left.load());
+      if (left == nullptr) {
+        if (node->key < inf0)
+          return node;
+        continue;
+      }
+      Node<T>* right = getPointer<T>(node->right.load());
+      stack.push_back(max ? left : right);
+      stack.push_back(max ? right : left);
+    }
+    return nullptr;
+  }
+
   bool cleanup(const T& key, const SeekRecord<T>& s) {
+    OpCounters::count(OpCounters::CLEANUP);
     const auto [ancestor, successor, parent, leaf] = s;
     std::atomic<uintptr_t>*successorAddr =
         key < ancestor->key ? &(ancestor->left) : &(ancestor->right),
@@ -144,7 +402,8 @@ struct NatarajanBST {
     uintptr_t siblingData =
         siblingAddr->fetch_or(Node<T>::TAG_MASK) & (~Node<T>::TAG_MASK);
     uintptr_t expected = getPointerUintRepr(successor);  // Remove all flags
-    return successorAddr->compare_exchange_strong(expected, siblingData);
+    return OpCounters::cas(
+        successorAddr->compare_exchange_strong(expected, siblingData));
   }
 
   void cleanup_all(Node<T>* node) {
@@ -2,9 +2,11 @@
 
 #include <algorithm>
 
+#include "src/Common/NumaAllocator.h"
+
 template <class T, std::size_t ALIGN = std::max(
                        {alignof(T), std::size_t(1 << 2), alignof(void*)})>
-struct alignas(ALIGN) Node {
+struct alignas(ALIGN) Node : Numa::Allocated {
   constexpr static uintptr_t FLAG_MASK = 2;
   constexpr static uintptr_t TAG_MASK = 1;
   constexpr static uintptr_t POINTER_MASK = ~(FLAG_MASK | TAG_MASK);
@@ -1,23 +1,34 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 
 #include "Operation.h"
+#include "src/Common/NumaAllocator.h"
 
 namespace Singh {
+// Bits of Node::deleted. Removes and update inserts bump the version with
+// every flip of DELETED, so a helper replaying an update insert that already
+// finished cannot undo a later remove.
+constexpr uint32_t DELETED = 1, FROZEN = 2, VERSION = 4;
+
 template <class T>
-struct Node {
+struct Node : Numa::Allocated {
   T key;
   std::atomic<Node<T>*> left{}, right{};
   std::atomic<OperationFlaggedPointer>
       op{};  // require uintptr_t as we need last 2 bits for flagging
   int local_height{}, lh{}, rh{};
-  std::atomic<uint8_t> deleted{};
+  std::atomic<uint32_t> deleted{};
   std::atomic<bool> removed{};
+  // Keys in the subtree when the balancing thread last passed it, only ever
+  // an estimate so accessed relaxed
+  std::atomic<std::size_t> size{};
 
   explicit Node(T key, Node<T>* left = nullptr, Node<T>* right = nullptr,
                 int local_height = 0, int lh = 0, int rh = 0,
-                uint8_t deleted = 0, bool removed = false)
+                uint32_t deleted = 0, bool removed = false)
       : key{key},
         left{left},
         right{right},
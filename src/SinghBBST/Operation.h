@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <variant>
 
 // Forward Declaration
@@ -31,14 +32,17 @@ struct InsertOp {
   bool isUpdate{false};
   Singh::Node<T>* expectedNode;
   Singh::Node<T>* newNode;
+  // Node::deleted an update expects to find, DELETED and its version
+  uint32_t expectedDeleted{};
   InsertOp(bool isLeft, Singh::Node<T>* expectedNode, Singh::Node<T>* newNode)
       : InsertOp{isLeft, false, expectedNode, newNode} {}
   InsertOp(bool isLeft, bool isUpdate, Singh::Node<T>* expectedNode,
-           Singh::Node<T>* newNode)
+           Singh::Node<T>* newNode, uint32_t expectedDeleted = 0)
       : isLeft{isLeft},
         isUpdate{isUpdate},
         expectedNode{expectedNode},
-        newNode{newNode} {}
+        newNode{newNode},
+        expectedDeleted{expectedDeleted} {}
 };
 
 template <typename T>
@@ -63,7 +67,7 @@ struct RotateOp {
         isLeftChild{isLeftChild} {}
 };
 
-OperationConstants::Flags getFlag(OperationFlaggedPointer ptr) {
+inline OperationConstants::Flags getFlag(OperationFlaggedPointer ptr) {
   return static_cast<OperationConstants::Flags>(ptr &
                                                 OperationConstants::FLAG_MASK);
 }
\ No newline at end of file
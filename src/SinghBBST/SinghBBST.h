@@ -1,10 +1,20 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <random>
 #include <thread>
 #include <utility>
+#include <vector>
 
+#include "src/Common/MemoryStats.h"
+#include "src/Common/OpCounters.h"
+#include "src/Common/RoutingIndex.h"
+#include "src/Common/ShapeStats.h"
+#include "src/Common/ShardedCounter.h"
 #include "src/SinghBBST/Node.h"
 #include "src/SinghBBST/Operation.h"
 #include "src/SinghBBST/SeekRecord.h"
@@ -14,6 +24,7 @@ struct SinghBBST {
   static Singh::Node<T>* const sentinel;  // For swapping purposes
 
   SinghBBST() {
+    allocatedNodes.add(1);
     // Init here to make sure all other fields are initialized
     maintainenceThread = std::thread(&SinghBBST<T>::maintain, this, root);
   }
@@ -26,7 +37,11 @@ struct SinghBBST {
   }
 
   bool operator[](const T& k) {
-    Singh::Node<T>*node = root, *nxt = root->left.load();
+    // A routed node is walked from like a child of the root
+    Singh::Node<T>* node = root;
+    Singh::Node<T>* nxt = route(k);
+    if (nxt == root)
+      nxt = root->left.load();
     OperationFlaggedPointer nodeOp = 0;
     T nodeKey;
     bool result = false;
@@ -52,27 +67,32 @@ struct SinghBBST {
 
   bool insert(const T& key) {
     Singh::Node<T>* newNode{nullptr};
-    while (true) {
+    for (bool retry = false;; retry = true) {
+      OpCounters::count(OpCounters::RETRY, retry);
       Singh::SeekRecord<T> result = seek(key);
-      if (result.result == SeekResultState::FOUND &&
-          (result.node->deleted.load() & 1) == 0)
+      const uint32_t deleted = result.node->deleted.load();
+      const bool isUpdate = result.result == SeekResultState::FOUND &&
+                            (deleted & Singh::DELETED) != 0;
+      if (result.result == SeekResultState::FOUND && !isUpdate)
         return false;
-      if (newNode == nullptr)
+      if (newNode == nullptr) {
         newNode = new Singh::Node<T>(key);
+        allocatedNodes.add(1);
+      }
 
       bool isLeft = (result.result == SeekResultState::NOT_FOUND_L);
       Singh::Node<T>* old =
           isLeft ? result.node->left.load() : result.node->right.load();
 
       Operation<T>* casOp =
-          new Operation<T>(std::in_place_type<InsertOp<T>>, isLeft,
-                           result.result == SeekResultState::FOUND &&
-                               (result.node->deleted.load() & 1) ==
-                                   1,  // TODO: Might need another fix
-                           old, newNode);
-      if (result.node->op.compare_exchange_strong(
-              result.nodeOp, Singh::flag(casOp, OperationConstants::INSERT))) {
+          new Operation<T>(std::in_place_type<InsertOp<T>>, isLeft, isUpdate,
+                           old, newNode, deleted);
+      allocatedOps.add(1);
+      if (OpCounters::cas(result.node->op.compare_exchange_strong(
+              result.nodeOp, Singh::flag(casOp, OperationConstants::INSERT)))) {
         helpInsert(casOp, result.node);
+        coverPopBounds(key);
+        countRouting(false);
         return true;
       }
     }
@@ -80,17 +100,19 @@ struct SinghBBST {
   }
 
   bool remove(const T& key) {
-    while (true) {
+    for (bool retry = false;; retry = true) {
+      OpCounters::count(OpCounters::RETRY, retry);
       Singh::SeekRecord<T> result = seek(key);
       if (result.result != SeekResultState::FOUND)
         return false;
-      if ((result.node->deleted.load() & 1) == 1) {
+      uint32_t deleted = result.node->deleted.load();
+      if ((deleted & Singh::DELETED) != 0) {
         if (getFlag(result.node->op.load()) != OperationConstants::INSERT)
           return false;
-      } else {
+      } else if ((deleted & Singh::FROZEN) == 0) {
         if (getFlag(result.node->op.load()) == OperationConstants::NONE) {
-          uint8_t expected = 0, desired = 1;
-          if (result.node->deleted.compare_exchange_strong(expected, desired)) {
+          if (OpCounters::cas(result.node->deleted.compare_exchange_strong(
+                  deleted, (deleted + Singh::VERSION) | Singh::DELETED))) {
             return true;
           }
         }
@@ -98,13 +120,149 @@ struct SinghBBST {
     }
   }
 
+  // Removes and returns the smallest key, nothing if the tree is empty. The
+  // key is the smallest in the tree unless inserts run next to pops, whose
+  // keys may be passed over. With spray > 0 the key is picked at random among
+  // about the 2^spray smallest, so threads popping together mostly remove
+  // different keys. Removed nodes are never unlinked, the walk starts at the
+  // smallest key the last pop saw instead of passing them all.
+  std::optional<T> try_pop_min(int spray = 0) { return pop(false, spray); }
+
+  // Removes and returns the largest key, as try_pop_min
+  std::optional<T> try_pop_max(int spray = 0) { return pop(true, spray); }
+
+  // Nodes replaced by rotations or removed and every operation record are
+  // never freed, they show up as retired and as descriptors. The balancing
+  // thread keeps rotating, so the walk is approximate.
+  MemoryStats memory_stats() {
+    MemoryStats stats;
+    std::vector<Singh::Node<T>*> stack{root};
+    while (!stack.empty()) {
+      Singh::Node<T>* node = stack.back();
+      stack.pop_back();
+      stats.liveNodes++;
+      if (node != root && (node->deleted.load() & 1) == 0)
+        stats.keys++;
+      if (Singh::Node<T>* left = node->left.load())
+        stack.push_back(left);
+      if (Singh::Node<T>* right = node->right.load())
+        stack.push_back(right);
+    }
+    stats.liveBytes = stats.liveNodes * sizeof(Singh::Node<T>);
+    const int64_t retired = allocatedNodes.load() - stats.liveNodes;
+    stats.retiredNodes = retired > 0 ? retired : 0;
+    stats.retiredBytes = stats.retiredNodes * sizeof(Singh::Node<T>);
+    const auto [current, replaced] = routing.bytes();
+    stats.descriptorBytes =
+        allocatedOps.load() * sizeof(Operation<T>) + current + replaced;
+    return stats;
+  }
+
+  // Walked from below the sentinel root. Logically deleted nodes stay in the
+  // tree until the balancing thread unlinks them, which also rotates during
+  // the walk.
+  ShapeStats shape_stats() {
+    return shapeOf(
+        root->left.load(),
+        [](Singh::Node<T>* node) {
+          return std::pair{node->left.load(), node->right.load()};
+        },
+        [](Singh::Node<T>* node) {
+          return (node->deleted.load() & 1) == 0 ? ShapeStats::Kind::KEY
+                                                 : ShapeStats::Kind::DELETED;
+        });
+  }
+
+  // Nodes on the longest path below the sentinel root
+  int height() { return shape_stats().height; }
+
+  // Order statistics from the subtree sizes the balancing thread counts on
+  // every pass, in O(height). They miss the updates since the pass reached
+  // the nodes on the way, so they are estimates while the tree changes.
+  std::size_t size() { return sizeOf(root->left.load()); }
+
+  // Estimated number of keys below key
+  std::size_t rank(const T& key) {
+    std::size_t below = 0;
+    for (Singh::Node<T>* node = root->left.load(); node != nullptr;) {
+      if (key < node->key) {
+        node = node->left.load();
+      } else if (key > node->key) {
+        below += sizeOf(node->left.load()) + isLive(node);
+        node = node->right.load();
+      } else {
+        return below + sizeOf(node->left.load());
+      }
+    }
+    return below;
+  }
+
+  // A key with about k keys below it, nothing if k is not below the estimated
+  // size. The last key the walk passed if the sizes below run out before k.
+  std::optional<T> select(std::size_t k) {
+    if (k >= size())
+      return std::nullopt;
+    std::optional<T> passed;
+    for (Singh::Node<T>* node = root->left.load(); node != nullptr;) {
+      const std::size_t left = sizeOf(node->left.load());
+      const bool live = isLive(node);
+      if (live)
+        passed = node->key;
+      if (k < left) {
+        node = node->left.load();
+      } else if (k == left && live) {
+        return node->key;
+      } else {
+        k -= std::min(k, left + live);
+        node = node->right.load();
+      }
+    }
+    return passed;
+  }
+
+  // Searches start from an index over the top levels of the tree, which is
+  // rebuilt as it goes stale, 0 levels turn it off. An entry is used while
+  // its node is neither frozen by a rotation nor removed, both of which
+  // happen before a node is unlinked. Rotations and removals only widen the
+  // keys routed through the nodes they leave in place.
+  void set_routing_levels(int levels) {
+    routing.reset(levels, [this](int levels) { return routingIndex(levels); });
+  }
+
  private:
   Singh::Node<T>* root = new Singh::Node<T>(T{inf});
+  ShardedCounter allocatedNodes, allocatedOps;
 
   static const OperationFlaggedPointer NULLOFP =
       reinterpret_cast<OperationFlaggedPointer>(nullptr);
   std::atomic<bool> finished{false};
   std::thread maintainenceThread;
+  Routing::Cache<T, Singh::Node<T>*> routing;
+  // No key below popMin or above popMax is in the tree once the inserts and
+  // pops running have returned. An insert moves a bound past its key after
+  // linking it, which only reads the bound while no pop moved it there. A pop
+  // moves a bound to the key its walk found, then walks there again and moves
+  // it back to any key linked meanwhile. Either the insert sees the moved
+  // bound or the second walk sees the key.
+  alignas(64) std::atomic<T> popMin{std::numeric_limits<T>::lowest()};
+  alignas(64) std::atomic<T> popMax{inf};
+
+  static bool isLive(const Singh::Node<T>* node) {
+    return (node->deleted.load() & Singh::DELETED) == 0;
+  }
+
+  static std::size_t sizeOf(const Singh::Node<T>* node) {
+    return node == nullptr ? 0 : node->size.load(std::memory_order_relaxed);
+  }
+
+  // Counts the keys below node from the sizes of its children
+  static void resize(Singh::Node<T>* node) {
+    if (node == nullptr)
+      return;
+    node->size.store(isLive(node) + sizeOf(node->left.load()) +
+                         sizeOf(node->right.load()),
+                     std::memory_order_relaxed);
+  }
 
   enum class HeightBalanceState {
     NO_ROTATION,  // Height diff <= 1
@@ -116,6 +274,7 @@ struct SinghBBST {
 
   void helpRotate(Operation<T>* op, Singh::Node<T>* parent,
                   Singh::Node<T>* node, Singh::Node<T>* child) {
+    OpCounters::count(OpCounters::HELP_ROTATE);
     RotateOp<T>& rotateOp = get<RotateOp<T>>(*op);
 
     for (int seen_state = rotateOp.state.load();
@@ -135,7 +294,7 @@ struct SinghBBST {
                                   desired = Singh::flag(
                                       op, OperationConstants::Flags::ROTATE);
           // No need extra checks whether it is decided or not, can only happen once (node never gets set back to NONE)
-          node->op.compare_exchange_strong(expected, desired);
+          OpCounters::cas(node->op.compare_exchange_strong(expected, desired));
         }
 
       } else if (seen_state == RotateOp<T>::GRABBED_FIRST) {
@@ -162,9 +321,9 @@ struct SinghBBST {
           // Eg. Interrupted and some other thread finished the rotation then an insertion happens is possible
           if (rotateOp.state.load() != RotateOp<T>::GRABBED_FIRST)
             continue;
-          child->op.compare_exchange_strong(
+          OpCounters::cas(child->op.compare_exchange_strong(
               expectedOp,
-              desiredOp);  // Success means rotateOp has not progressed beyond GRABBED_FIRST
+              desiredOp));  // Success means rotateOp has not progressed beyond GRABBED_FIRST
         }
 
       } else if (seen_state == RotateOp<T>::GRABBED_SECOND) {
@@ -172,16 +331,20 @@ struct SinghBBST {
         Singh::Node<T>* expected = rotateOp.grandchild.load();
         Singh::Node<T>* newNode;
         if (rotateOp.isLeftRotation) {
-          uint8_t deleted = node->deleted.fetch_or(2) &
-                            1u;  // Make sure it's unusable for remove
+          // Make sure it's unusable for remove
+          uint32_t deleted =
+              node->deleted.fetch_or(Singh::FROZEN) & Singh::DELETED;
           newNode = new Singh::Node<T>{
               node->key, node->left.load(), rotateOp.grandchild.load(), 0, 0,
               0,         deleted,           node->removed.load()};
           newNode->op.store(Singh::flag(op, OperationConstants::ROTATE));
-          if (!child->left.compare_exchange_strong(expected, newNode))
+          if (child->left.compare_exchange_strong(expected, newNode))
+            allocatedNodes.add(1);
+          else
             delete newNode;  // Only happens successfully once
         } else {
-          uint8_t deleted = node->deleted.fetch_or(2) & 1u;
+          uint32_t deleted =
+              node->deleted.fetch_or(Singh::FROZEN) & Singh::DELETED;
           newNode = new Singh::Node<T>{node->key,
                                        rotateOp.grandchild.load(),
                                        node->right.load(),
@@ -191,16 +354,20 @@ struct SinghBBST {
                                        deleted,
                                        node->removed.load()};
           newNode->op.store(Singh::flag(op, OperationConstants::ROTATE));
-          if (!child->right.compare_exchange_strong(expected, newNode))
+          if (child->right.compare_exchange_strong(expected, newNode))
+            allocatedNodes.add(1);
+          else
             delete newNode;  // Only happens successfully once
         }
 
         // Final CAS for parent to swap to correct node
         if (Singh::Node<T>* expected = node, *desired = child;
             rotateOp.isLeftChild) {
-          parent->left.compare_exchange_strong(expected, desired);
+          OpCounters::cas(
+              parent->left.compare_exchange_strong(expected, desired));
         } else {
-          parent->right.compare_exchange_strong(expected, desired);
+          OpCounters::cas(
+              parent->right.compare_exchange_strong(expected, desired));
         }
 
         int expectedState = RotateOp<T>::GRABBED_SECOND,
@@ -256,8 +423,10 @@ struct SinghBBST {
           new Operation<T>(std::in_place_type<RotateOp<T>>, parent, current,
                            child, true, isLeftChild, sentinel);
 
-      if (parent->op.compare_exchange_strong(
-              parentOp, Singh::flag(rotationOp, OperationConstants::ROTATE))) {
+      if (OpCounters::cas(parent->op.compare_exchange_strong(
+              parentOp,
+              Singh::flag(rotationOp, OperationConstants::ROTATE)))) {
+        allocatedOps.add(1);
         helpRotate(rotationOp, parent, current, child);
         return HeightBalanceState::LEFT_ROTATE;
       } else {
@@ -289,8 +458,10 @@ struct SinghBBST {
       Operation<T>* rotationOp =
           new Operation<T>(std::in_place_type<RotateOp<T>>, parent, current,
                            child, false, isLeftChild, sentinel);
-      if (parent->op.compare_exchange_strong(
-              parentOp, Singh::flag(rotationOp, OperationConstants::ROTATE))) {
+      if (OpCounters::cas(parent->op.compare_exchange_strong(
+              parentOp,
+              Singh::flag(rotationOp, OperationConstants::ROTATE)))) {
+        allocatedOps.add(1);
         helpRotate(rotationOp, parent, current, child);
         return HeightBalanceState::RIGHT_ROTATE;
       } else {
@@ -319,6 +490,7 @@ struct SinghBBST {
     if (!forced)
       node->rh = maintainHelper(node->right.load(), node, false, false);
     node->local_height = std::max(node->lh, node->rh) + 1;
+    resize(node);
 
     HeightBalanceState state = checkBalance(node, forced);
     if (state == HeightBalanceState::NO_ROTATION)
@@ -337,6 +509,15 @@ struct SinghBBST {
       }
     }
 
+    // A rotation put a copy of node below the child that took its place,
+    // neither has its size yet
+    if (Singh::Node<T>* top =
+            isLeftChild ? parent->left.load() : parent->right.load()) {
+      resize(top->left.load());
+      resize(top->right.load());
+      resize(top);
+    }
+
     if (state != HeightBalanceState::NO_ROTATION)
       node->local_height--;
     return node->local_height;
@@ -357,25 +538,29 @@ struct SinghBBST {
     node->removed = true;
     Operation<T>* casOp = new Operation<T>(std::in_place_type<InsertOp<T>>,
                                            node == parent->left, node, child);
+    allocatedOps.add(1);
     OperationFlaggedPointer expected =
         reinterpret_cast<OperationFlaggedPointer>(parentOp);
-    if (parent->op.compare_exchange_strong(
-            expected, Singh::flag(casOp, OperationConstants::INSERT))) {
+    if (OpCounters::cas(parent->op.compare_exchange_strong(
+            expected, Singh::flag(casOp, OperationConstants::INSERT)))) {
       helpInsert(casOp, parent);
     }
   }
 
   void helpInsert(Operation<T>* op, Singh::Node<T>* dest) {
     // TODO: Assumed op to be unflagged
+    OpCounters::count(OpCounters::HELP_INSERT);
     InsertOp<T>& insertOp = get<InsertOp<T>>(*op);
     if (insertOp.isUpdate) {
-      uint8_t expected = 1, desired = 0;
-      // Should not encounter 2/3
-      dest->deleted.compare_exchange_strong(expected, desired);
+      // Fails if the update already happened, or a rotation froze the node
+      uint32_t expected = insertOp.expectedDeleted;
+      dest->deleted.compare_exchange_strong(
+          expected, (expected + Singh::VERSION) & ~Singh::DELETED);
     } else {
       std::atomic<Singh::Node<T>*>& addr =
           insertOp.isLeft ? dest->left : dest->right;
-      addr.compare_exchange_strong(insertOp.expectedNode, insertOp.newNode);
+      OpCounters::cas(addr.compare_exchange_strong(insertOp.expectedNode,
+                                                   insertOp.newNode));
     }
 
     OperationFlaggedPointer expected =
@@ -386,6 +571,7 @@ struct SinghBBST {
 
   void help(Singh::Node<T>* parent, OperationFlaggedPointer parentOp,
             Singh::Node<T>* node, OperationFlaggedPointer nodeOp) {
+    OpCounters::count(OpCounters::HELP);
     if (getFlag(nodeOp) == OperationConstants::INSERT) {
       helpInsert(Singh::unFlag<T>(nodeOp), node);
     } else if (getFlag(parentOp) == OperationConstants::ROTATE) {
@@ -398,31 +584,221 @@ struct SinghBBST {
     }
   }
 
+  // Node of key in the routing index if it is still valid and key is neither
+  // its key nor one above it, the root otherwise
+  Singh::Node<T>* route(const T& key) {
+    if (routing.levels() == 0)
+      return root;
+
+    {
+      auto guard = routing.pin();
+      const auto* index = routing.load();
+      if (index == nullptr)
+        return root;
+
+      const std::size_t entry = index->find(key);
+      Singh::Node<T>* node = index->entries[entry];
+      // The smallest key of an entry is the one of a node above it
+      if (node->key == key || (entry > 0 && index->bounds[entry - 1] == key))
+        return root;
+      if ((node->deleted.load() & Singh::FROZEN) == 0 &&
+          !node->removed.load()) {
+        OpCounters::count(OpCounters::ROUTED);
+        return node;
+      }
+    }
+    // Unpinned, counting may rebuild the index
+    OpCounters::count(OpCounters::ROUTE_STALE);
+    countRouting(true);
+    return root;
+  }
+
+  void countRouting(bool stale) {
+    routing.count(stale, [this](int levels) { return routingIndex(levels); });
+  }
+
+  // Nodes levels below the sentinel root, or the ones above them missing a
+  // child, in key order
+  Routing::Index<T, Singh::Node<T>*> routingIndex(int levels) {
+    struct Frame {
+      Singh::Node<T>* node;
+      T low;
+      int depth;
+    };
+
+    Routing::Index<T, Singh::Node<T>*> index;
+    Singh::Node<T>* top = root->left.load();
+    if (top == nullptr) {
+      index.shallow = true;
+      index.add(T{}, root);
+      return index;
+    }
+    // The smallest key of the first entry is never compared against
+    std::vector<Frame> stack{{top, T{}, 1}};
+    while (!stack.empty()) {
+      const Frame frame = stack.back();
+      stack.pop_back();
+      Singh::Node<T>*left = frame.node->left.load(),
+      *right = frame.node->right.load();
+      // Children of a node that was still linked after reading them route a
+      // part of its keys. The ones of a node that moved may not, it is kept
+      // as a stale entry instead.
+      const bool moved = (frame.node->deleted.load() & Singh::FROZEN) != 0 ||
+                         frame.node->removed.load();
+      if (moved || frame.depth == levels || left == nullptr ||
+          right == nullptr) {
+        index.shallow |= !moved && frame.depth < levels;
+        index.add(frame.low, frame.node);
+        continue;
+      }
+      stack.push_back({right, frame.node->key, frame.depth + 1});
+      stack.push_back({left, frame.low, frame.depth + 1});
+    }
+    return index;
+  }
+
+  void coverPopBounds(const T& key) {
+    widenBound(popMin, key, false);
+    widenBound(popMax, key, true);
+  }
+
+  // Moves bound to key if key is beyond it on the side pops of max take from
+  static void widenBound(std::atomic<T>& bound, const T& key, bool max) {
+    for (T seen = bound.load(); (max ? key > seen : key < seen) &&
+                                !bound.compare_exchange_weak(seen, key);)
+      ;
+  }
+
+  std::optional<T> pop(bool max, int spray) {
+    for (bool retry = false;; retry = true) {
+      OpCounters::count(OpCounters::RETRY, retry);
+      Singh::Node<T>* node = pick(max, spray);
+      if (node == nullptr)
+        return std::nullopt;
+      // Fails if another thread removed it first
+      if (remove(node->key))
+        return node->key;
+    }
+  }
+
+  // Node holding the smallest or largest key, or one below the node spray
+  // levels above it on the path there, reached by random turns. nullptr if
+  // the tree is empty.
+  Singh::Node<T>* pick(bool max, int spray) {
+    thread_local std::minstd_rand gen{std::random_device{}()};
+    std::atomic<T>& bound = max ? popMax : popMin;
+    T seen = bound.load();
+    Singh::Node<T>* top = root->left.load();
+    Singh::Node<T>* first = firstLive(top, max, seen);
+    if (first == nullptr)
+      return nullptr;
+    if (first->key != seen && bound.compare_exchange_strong(seen, first->key)) {
+      // An insert that read the bound before it moved linked its key before
+      // this walk
+      if (Singh::Node<T>* missed = firstLive(root->left.load(), max, seen)) {
+        widenBound(bound, missed->key, max);
+        first = missed;
+      }
+    }
+    if (spray == 0)
+      return first;
+
+    std::vector<Singh::Node<T>*> spine;
+    for (Singh::Node<T>* next = top; next != nullptr;) {
+      spine.push_back(next);
+      const bool left = max ? next->key > seen : next->key >= seen;
+      next = left ? next->left.load() : next->right.load();
+    }
+    Singh::Node<T>* node =
+        spine[spine.size() - 1 - std::min<std::size_t>(spray, spine.size() - 1)];
+    for (int i = 0; i < spray; i++) {
+      Singh::Node<T>* next = gen() & 1 ? node->right.load() : node->left.load();
+      if (next == nullptr)
+        break;
+      node = next;
+    }
+    Singh::Node<T>* found = firstLive(node, max, seen);
+    return found != nullptr ? found : first;
+  }
+
+  // First node below top in key order from bound, or reverse order down from
+  // it for max, that is not deleted. A rotation froze the copy of a node the
+  // walk reached, which may be deleted or not unlike the node that replaced
+  // it, so the walk restarts from the root.
+  Singh::Node<T>* firstLive(Singh::Node<T>* node, bool max, const T& bound) {
+    // Whether a key is on the side of bound the walk goes to
+    const auto inRange = [max, &bound](const T& key) {
+      return max ? key <= bound : key >= bound;
+    };
+    std::vector<Singh::Node<T>*> stack;
+    while (node != nullptr || !stack.empty()) {
+      if (node != nullptr) {
+        // Nodes out of range are skipped along with the subtree before them
+        const bool keep = inRange(node->key);
+        if (keep)
+          stack.push_back(node);
+        node = keep == max ? node->right.load() : node->left.load();
+        continue;
+      }
+      node = stack.back();
+      stack.pop_back();
+      const uint32_t deleted = node->deleted.load();
+      if ((deleted & Singh::FROZEN) != 0) {
+        stack.clear();
+        node = root->left.load();
+      } else if ((deleted & Singh::DELETED) == 0) {
+        return node;
+      } else {
+        node = max ? node->left.load() : node->right.load();
+      }
+    }
+    return nullptr;
+  }
+
   Singh::SeekRecord<T> seek(const T& key) {
     Singh::SeekRecord<T> res{};
     T nodeKey;
     Singh::Node<T>* nxt;
+    uint64_t depth;
+    // Restarts go through the root
+    Singh::Node<T>* start = route(key);
 
   retry:
+    depth = 0;
     res.result = SeekResultState::NOT_FOUND_L;
-    res.node = root;
+    res.node = start;
+    start = root;
     res.nodeOp = res.node->op.load();
 
     if (getFlag(res.nodeOp) == OperationConstants::INSERT) {
       helpInsert(Singh::unFlag<T>(res.nodeOp), res.node);
+      OpCounters::count(OpCounters::SEEK_RESTART);
       goto retry;
     } else if (getFlag(res.nodeOp) == OperationConstants::ROTATE) {
       help(res.node, res.nodeOp, nullptr, NULLOFP);
+      OpCounters::count(OpCounters::SEEK_RESTART);
+      goto retry;
+    } else if (getFlag(res.nodeOp) == OperationConstants::MARK) {
+      // Only a routed start is marked, helping needs its parent
+      OpCounters::count(OpCounters::SEEK_RESTART);
       goto retry;
     }
 
-    nxt = res.node->left.load();
+    // Every key is below the one of the root, a routed start may have no
+    // child towards key
+    if (key > res.node->key) {
+      res.result = SeekResultState::NOT_FOUND_R;
+      nxt = res.node->right.load();
+    } else {
+      nxt = res.node->left.load();
+    }
     while (nxt != nullptr && res.result != SeekResultState::FOUND) {
       res.parent = res.node;
       res.parentOp = res.nodeOp;
       res.node = nxt;
       res.nodeOp = res.node->op.load();
       nodeKey = res.node->key;
+      depth++;
 
       if (key < nodeKey) {
         res.result = SeekResultState::NOT_FOUND_L;
@@ -437,8 +813,11 @@ struct SinghBBST {
 
     if (getFlag(res.nodeOp) != OperationConstants::NONE) {
       help(res.parent, res.parentOp, res.node, res.nodeOp);
+      OpCounters::count(OpCounters::SEEK_RESTART);
       goto retry;
     }
+    OpCounters::count(OpCounters::SEEK);
+    OpCounters::count(OpCounters::SEEK_DEPTH, depth);
     return res;
   }
 };
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include "VersionedPtr.h"
+#include "src/Common/NumaAllocator.h"
+
+namespace Snapshot {
+// Edges carry the flag and tag bits of Natarajan's algorithm, so a node must
+// be at least 4 byte aligned
+template <class T>
+struct Node : Numa::Allocated {
+  constexpr static uintptr_t FLAG_MASK = 2;
+  constexpr static uintptr_t TAG_MASK = 1;
+  constexpr static uintptr_t POINTER_MASK = ~(FLAG_MASK | TAG_MASK);
+
+  const T key;
+  VersionedPtr left, right;
+
+  explicit Node(const T& key, Node<T>* l = nullptr, Node<T>* r = nullptr)
+      : key{key},
+        left{reinterpret_cast<uintptr_t>(l)},
+        right{reinterpret_cast<uintptr_t>(r)} {}
+};
+
+template <class T>
+Node<T>* getPointer(uintptr_t field) {
+  return reinterpret_cast<Node<T>*>(field & Node<T>::POINTER_MASK);
+}
+
+template <class T>
+uintptr_t toField(Node<T>* node) {
+  return reinterpret_cast<uintptr_t>(node);
+}
+
+template <class T>
+struct SeekRecord {
+  Node<T>*ancestor, *successor, *parent, *leaf;
+  // Edge from parent to leaf, a set flag means leaf is being deleted
+  uintptr_t leafField;
+};
+}  // namespace Snapshot
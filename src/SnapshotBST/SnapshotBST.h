@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Node.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/ShapeStats.h"
+
+// NatarajanBST whose edges are versioned CAS objects, which makes snapshot()
+// a single clock tick. A snapshot reads every edge as it was at its
+// timestamp, so it stays consistent while writers carry on. A leaf behind a
+// flagged edge counts as deleted, the flag is where removal linearises.
+// Unlinked nodes may still be part of older snapshots, they wait until every
+// snapshot is newer than their unlinking and are then retired through an
+// epoch manager, since concurrent updates may still be walking them.
+template <class T, T inf0 = std::numeric_limits<T>::max() - 2,
+          T inf1 = std::numeric_limits<T>::max() - 1,
+          T inf2 = std::numeric_limits<T>::max()>
+struct SnapshotBST {
+  using Node = Snapshot::Node<T>;
+  using SeekRecord = Snapshot::SeekRecord<T>;
+
+  // Immutable view of the tree, versions it needs are kept until it is
+  // destroyed
+  struct View {
+    View(View&& other) noexcept : tree{other.tree}, ts{other.ts} {
+      other.tree = nullptr;
+    }
+    View(const View&) = delete;
+    ~View() {
+      if (tree != nullptr)
+        tree->clock.release(ts);
+    }
+
+    bool operator[](const T& key) const {
+      uintptr_t field = tree->root->left.loadAt(ts, tree->clock);
+      Node* node = Snapshot::getPointer<T>(field);
+      while (true) {
+        const uintptr_t next =
+            (key < node->key ? node->left : node->right).loadAt(ts,
+                                                                 tree->clock);
+        if (next == 0)
+          return node->key == key && (field & Node::FLAG_MASK) == 0;
+        field = next;
+        node = Snapshot::getPointer<T>(field);
+      }
+    }
+
+    // Calls f with every key in ascending order
+    template <class F>
+    void for_each(F&& f) const {
+      std::vector<uintptr_t> stack{tree->root->left.loadAt(ts, tree->clock)};
+      while (!stack.empty()) {
+        const uintptr_t field = stack.back();
+        stack.pop_back();
+        Node* node = Snapshot::getPointer<T>(field);
+        const uintptr_t left = node->left.loadAt(ts, tree->clock);
+        if (left == 0) {
+          if ((field & Node::FLAG_MASK) == 0 && node->key < inf0)
+            f(node->key);
+          continue;
+        }
+        stack.push_back(node->right.loadAt(ts, tree->clock));
+        stack.push_back(left);
+      }
+    }
+
+   private:
+    friend struct SnapshotBST;
+
+    SnapshotBST* tree;
+    uint64_t ts;
+
+    View(SnapshotBST* tree, uint64_t ts) : tree{tree}, ts{ts} {}
+  };
+
+  Node* root;
+
+  SnapshotBST() {
+    auto* S = new Node(inf1, new Node(inf0), new Node(inf1));
+    root = new Node(inf2, S, new Node(inf2));
+  }
+
+  ~SnapshotBST() {
+    cleanup_all(root);
+    for (const auto& [stamp, node] : unlinkedNodes)
+      delete node;
+  }
+
+  View snapshot() { return View{this, clock.acquire()}; }
+
+  bool operator[](const T& key) {
+    auto guard = pin();
+    SeekRecord s = seek(key);
+    return s.leaf->key == key && (s.leafField & Node::FLAG_MASK) == 0;
+  }
+
+  bool insert(const T& key) {
+    auto guard = pin();
+    auto* newLeaf = new Node(key);
+
+    while (true) {
+      SeekRecord s = seek(key);
+      if (s.leaf->key == key) {
+        if ((s.leafField & Node::FLAG_MASK) == 0) {
+          delete newLeaf;
+          return false;
+        }
+        // Removal of key already linearised, help it finish
+        cleanup(key, s);
+        continue;
+      }
+
+      Node *parent = s.parent, *l = newLeaf, *r = s.leaf;
+      Snapshot::VersionedPtr& child =
+          key < parent->key ? parent->left : parent->right;
+      if (l->key > r->key)
+        std::swap(l, r);
+
+      auto* newInternal = new Node(r->key, l, r);
+      if (child.compareExchange(Snapshot::toField(s.leaf),
+                                Snapshot::toField(newInternal), clock,
+                                versions))
+        return true;
+      delete newInternal;
+
+      const uintptr_t c = child.load(clock);
+      if (Snapshot::getPointer<T>(c) == s.leaf &&
+          (c & ~Node::POINTER_MASK) != 0) {
+        cleanup(key, s);
+      }
+    }
+  }
+
+  bool remove(const T& key) {
+    auto guard = pin();
+    DeleteMode mode = DeleteMode::INJECTION;
+    Node* leaf = nullptr;
+
+    while (true) {
+      SeekRecord s = seek(key);
+      Snapshot::VersionedPtr& child =
+          key < s.parent->key ? s.parent->left : s.parent->right;
+      if (mode == DeleteMode::INJECTION) {
+        leaf = s.leaf;
+        if (leaf->key != key)
+          return false;
+        const uintptr_t expected = Snapshot::toField(leaf);
+        if (child.compareExchange(expected, expected | Node::FLAG_MASK, clock,
+                                  versions)) {
+          mode = DeleteMode::CLEANUP;
+          if (cleanup(key, s))
+            return true;
+        } else {
+          const uintptr_t c = child.load(clock);
+          if (Snapshot::getPointer<T>(c) == leaf &&
+              (c & ~Node::POINTER_MASK) != 0)
+            cleanup(key, s);
+        }
+      } else {
+        if (s.leaf != leaf || cleanup(key, s))
+          return true;
+      }
+    }
+  }
+
+  // Versions still on an edge count as descriptors, trimmed ones waiting for
+  // their epoch as retired, like unlinked nodes
+  MemoryStats memory_stats() {
+    auto guard = pin();
+    MemoryStats stats;
+    std::size_t versionCount = 0;
+    std::vector<uintptr_t> stack{Snapshot::toField(root)};
+    while (!stack.empty()) {
+      const uintptr_t field = stack.back();
+      stack.pop_back();
+      Node* node = Snapshot::getPointer<T>(field);
+      stats.liveNodes++;
+      versionCount += node->left.versionCount() + node->right.versionCount();
+      const uintptr_t left = node->left.load(clock);
+      if (left == 0) {
+        stats.keys += (field & Node::FLAG_MASK) == 0 && node->key < inf0;
+        continue;
+      }
+      stack.push_back(left);
+      stack.push_back(node->right.load(clock));
+    }
+    stats.liveBytes = stats.liveNodes * sizeof(Node);
+
+    std::lock_guard lk{unlinkedMut};
+    for (const auto& [stamp, node] : unlinkedNodes)
+      versionCount += node->left.versionCount() + node->right.versionCount();
+    const std::size_t retiredNodes = unlinkedNodes.size() + nodes.pending();
+    stats.retiredNodes = retiredNodes + versions.pending();
+    stats.retiredBytes = retiredNodes * sizeof(Node) +
+                         versions.pending() * sizeof(Snapshot::Version);
+    stats.descriptorBytes = versionCount * sizeof(Snapshot::Version);
+    return stats;
+  }
+
+  // Walked over the current edges from the root, sentinels included. A leaf
+  // behind a flagged edge is removed but not unlinked yet.
+  ShapeStats shape_stats() {
+    auto guard = pin();
+    return shapeOf(
+        Snapshot::toField(root),
+        [this](uintptr_t field) {
+          Node* node = Snapshot::getPointer<T>(field);
+          return std::pair{node->left.load(clock), node->right.load(clock)};
+        },
+        [this](uintptr_t field) {
+          Node* node = Snapshot::getPointer<T>(field);
+          if (node->left.load(clock) != 0 || node->key >= inf0)
+            return ShapeStats::Kind::ROUTING;
+          return (field & Node::FLAG_MASK) == 0 ? ShapeStats::Kind::KEY
+                                                : ShapeStats::Kind::DELETED;
+        });
+  }
+
+ private:
+  enum class DeleteMode { INJECTION, CLEANUP };
+
+  Snapshot::Clock clock{};
+  Epoch::Manager<Snapshot::Version> versions{};
+  Epoch::Manager<Node> nodes{};
+  std::mutex unlinkedMut{};
+  // Unlinked nodes with the clock at their unlinking, oldest first
+  std::vector<std::pair<uint64_t, Node*>> unlinkedNodes;
+
+  struct Pinned {
+    Epoch::Manager<Snapshot::Version>::Guard versions;
+    Epoch::Manager<Node>::Guard nodes;
+  };
+
+  Pinned pin() { return Pinned{versions.pin(), nodes.pin()}; }
+
+  SeekRecord seek(const T& key) {
+    SeekRecord s;
+    s.ancestor = root;
+    s.successor = Snapshot::getPointer<T>(root->left.load(clock));
+    s.parent = s.successor;
+    s.leafField = s.successor->left.load(clock);
+    s.leaf = Snapshot::getPointer<T>(s.leafField);
+
+    uintptr_t currentField = s.leaf->left.load(clock);
+    for (Node* current = Snapshot::getPointer<T>(currentField);
+         current != nullptr;
+         current = Snapshot::getPointer<T>(currentField)) {
+      if ((s.leafField & Node::TAG_MASK) == 0) {
+        s.ancestor = s.parent;
+        s.successor = s.leaf;
+      }
+      s.parent = s.leaf;
+      s.leaf = current;
+      s.leafField = currentField;
+
+      if (key < current->key)
+        currentField = current->left.load(clock);
+      else
+        currentField = current->right.load(clock);
+    }
+
+    return s;
+  }
+
+  // fetch_or of the tag bit, which has to go through a new version too
+  uintptr_t tag(Snapshot::VersionedPtr& edge) {
+    uintptr_t field = edge.load(clock);
+    while ((field & Node::TAG_MASK) == 0 &&
+           !edge.compareExchange(field, field | Node::TAG_MASK, clock,
+                                 versions))
+      field = edge.load(clock);
+    return field;
+  }
+
+  bool cleanup(const T& key, const SeekRecord& s) {
+    const auto [ancestor, successor, parent, leaf, leafField] = s;
+    Snapshot::VersionedPtr& successorAddr =
+        key < ancestor->key ? ancestor->left : ancestor->right;
+    Snapshot::VersionedPtr *childAddr = &(parent->right),
+                           *siblingAddr = &(parent->left);
+
+    if (key < parent->key)
+      std::swap(childAddr, siblingAddr);
+
+    if ((childAddr->load(clock) & Node::FLAG_MASK) == 0)
+      siblingAddr = childAddr;
+
+    const uintptr_t siblingData = tag(*siblingAddr) & ~Node::TAG_MASK;
+    if (!successorAddr.compareExchange(Snapshot::toField(successor),
+                                       siblingData, clock, versions))
+      return false;
+
+    retirePath(key, successor, parent, siblingAddr);
+    return true;
+  }
+
+  // The path from successor to parent is frozen by tags, every node on it and
+  // the flagged leaf hanging off it is now unreachable for snapshots taken
+  // from now on. Caller is pinned.
+  void retirePath(const T& key, Node* successor, Node* parent,
+                  Snapshot::VersionedPtr* siblingAddr) {
+    std::vector<Node*> unlinked;
+    Node* node = successor;
+    while (node != parent) {
+      const bool goLeft = key < node->key;
+      unlinked.push_back(Snapshot::getPointer<T>(
+          (goLeft ? node->right : node->left).load(clock)));
+      unlinked.push_back(node);
+      node = Snapshot::getPointer<T>(
+          (goLeft ? node->left : node->right).load(clock));
+    }
+    Snapshot::VersionedPtr& removedAddr =
+        siblingAddr == &(parent->left) ? parent->right : parent->left;
+    unlinked.push_back(Snapshot::getPointer<T>(removedAddr.load(clock)));
+    unlinked.push_back(parent);
+
+    std::lock_guard lk{unlinkedMut};
+    // Read under the lock so the stamps stay in order
+    const uint64_t stamp = clock.now.load();
+    for (Node* node : unlinked)
+      unlinkedNodes.emplace_back(stamp, node);
+
+    // A snapshot at or after the stamp reads the edge that unlinked the node
+    const uint64_t bound = clock.reclaimBound();
+    auto hidden = std::find_if(
+        unlinkedNodes.begin(), unlinkedNodes.end(),
+        [bound](const auto& entry) { return entry.first > bound; });
+    for (auto it = unlinkedNodes.begin(); it != hidden; ++it)
+      nodes.retire(it->second);
+    unlinkedNodes.erase(unlinkedNodes.begin(), hidden);
+  }
+
+  void cleanup_all(Node* node) {
+    if (node == nullptr)
+      return;
+    cleanup_all(Snapshot::getPointer<T>(node->left.load(clock)));
+    cleanup_all(Snapshot::getPointer<T>(node->right.load(clock)));
+    delete node;
+  }
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <set>
+
+#include "src/Common/Epoch.h"
+
+namespace Snapshot {
+constexpr uint64_t PENDING = std::numeric_limits<uint64_t>::max();
+
+// Logical clock of one tree. Taking a snapshot ticks it, every update stamps
+// its version with the value it reads afterwards.
+struct Clock {
+  std::atomic<uint64_t> now{1};
+
+  // The snapshot is registered before the clock ticks, so reclaimBound never
+  // overshoots a snapshot that is being taken
+  uint64_t acquire() {
+    std::lock_guard lk{mut};
+    const uint64_t ts = now.load();
+    active.insert(ts);
+    oldestActive.store(*active.begin());
+    now.fetch_add(1);
+    return ts;
+  }
+
+  void release(uint64_t ts) {
+    std::lock_guard lk{mut};
+    active.erase(ts);
+    oldestActive.store(active.empty() ? PENDING : *active.begin());
+  }
+
+  // Every live snapshot reads at or after this timestamp
+  uint64_t reclaimBound() const {
+    const uint64_t ts = now.load();
+    return std::min(ts, oldestActive.load());
+  }
+
+ private:
+  std::mutex mut;
+  std::set<uint64_t> active;
+  std::atomic<uint64_t> oldestActive{PENDING};
+};
+
+struct Version {
+  const uintptr_t value;
+  std::atomic<uint64_t> stamp;
+  std::atomic<Version*> next;
+
+  Version(uintptr_t value, uint64_t stamp, Version* next)
+      : value{value}, stamp{stamp}, next{next} {}
+};
+
+// Versioned CAS object after Wei et al., "Constant-Time Snapshots with
+// Applications to Concurrent Data Structures". The current value heads a
+// chain of older ones, newest first, which snapshots read by timestamp.
+// Versions no live snapshot can reach are trimmed after each update and
+// freed through the epoch manager, since concurrent updates may still be
+// looking at them. Null edges never change and own no version.
+struct VersionedPtr {
+  explicit VersionedPtr(uintptr_t value)
+      : head{value == 0 ? nullptr : new Version(value, 0, nullptr)} {}
+
+  ~VersionedPtr() {
+    for (Version* v = head.load(); v != nullptr;) {
+      Version* next = v->next.load();
+      delete v;
+      v = next;
+    }
+  }
+
+  uintptr_t load(Clock& clock) const {
+    Version* v = head.load();
+    if (v == nullptr)
+      return 0;
+    initStamp(v, clock);
+    return v->value;
+  }
+
+  uintptr_t loadAt(uint64_t ts, Clock& clock) const {
+    Version* v = head.load();
+    if (v == nullptr)
+      return 0;
+    initStamp(v, clock);
+    while (v->stamp.load() > ts)
+      v = v->next.load();
+    return v->value;
+  }
+
+  // Caller is pinned in epochs
+  bool compareExchange(uintptr_t expected, uintptr_t desired, Clock& clock,
+                       Epoch::Manager<Version>& epochs) {
+    Version* h = head.load();
+    initStamp(h, clock);
+    if (h->value != expected)
+      return false;
+    if (expected == desired)
+      return true;
+
+    auto* v = new Version(desired, PENDING, h);
+    if (!head.compare_exchange_strong(h, v)) {
+      delete v;
+      initStamp(head.load(), clock);
+      return false;
+    }
+    initStamp(v, clock);
+    trim(clock, epochs);
+    return true;
+  }
+
+  std::size_t versionCount() const {
+    std::size_t count = 0;
+    for (Version* v = head.load(); v != nullptr; v = v->next.load())
+      count++;
+    return count;
+  }
+
+ private:
+  std::atomic<Version*> head;
+  std::atomic<bool> trimming{false};
+
+  static void initStamp(Version* v, Clock& clock) {
+    uint64_t pending = PENDING;
+    if (v->stamp.load() == PENDING)
+      v->stamp.compare_exchange_strong(pending, clock.now.load());
+  }
+
+  // Keeps the newest version stamped at or before the bound, the ones behind
+  // it are older than any live snapshot
+  void trim(Clock& clock, Epoch::Manager<Version>& epochs) {
+    if (trimming.exchange(true, std::memory_order_acquire))
+      return;
+
+    const uint64_t bound = clock.reclaimBound();
+    Version* v = head.load();
+    while (v != nullptr && v->stamp.load() > bound)
+      v = v->next.load();
+    if (v != nullptr) {
+      for (Version* old = v->next.exchange(nullptr); old != nullptr;) {
+        Version* next = old->next.load();
+        epochs.retire(old);
+        old = next;
+      }
+    }
+    trimming.store(false, std::memory_order_release);
+  }
+};
+}  // namespace Snapshot
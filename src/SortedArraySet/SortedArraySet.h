@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+#include "src/Common/Epoch.h"
+#include "src/Common/MemoryStats.h"
+#include "src/Common/NumaAllocator.h"
+
+namespace SortedArray {
+// One immutable state of the set, never written to once published
+template <class T>
+struct Version : Numa::Allocated {
+  std::vector<T, Numa::Allocator<T>> keys;
+};
+}  // namespace SortedArray
+
+// Read-mostly set kept as a sorted array behind an atomically published
+// pointer. Lookups pin an epoch and binary search the current version, they
+// only write to their own epoch slot and never wait. Updates serialise on a
+// lock, merge into a copy of the array and publish it, so an update costs
+// O(n) and insert_all / remove_all should be preferred for many keys. Old
+// versions are freed once every lookup that could see them has finished.
+template <class T>
+struct SortedArraySet {
+  using Version = SortedArray::Version<T>;
+
+  SortedArraySet() : current{new Version()} {}
+  SortedArraySet(const SortedArraySet&) = delete;
+  ~SortedArraySet() { delete current.load(); }
+
+  bool operator[](const T& key) {
+    auto guard = versions.pin();
+    return contains(current.load(std::memory_order_acquire)->keys, key);
+  }
+
+  bool insert(const T& key) { return insert_all(&key, &key + 1) == 1; }
+
+  bool remove(const T& key) { return remove_all(&key, &key + 1) == 1; }
+
+  // Inserts every key of the range as one update, returns how many were not
+  // in the set yet
+  template <class It>
+  std::size_t insert_all(It first, It last) {
+    std::lock_guard lk{writer};
+    const Version* old = current.load(std::memory_order_relaxed);
+    std::vector<T> batch = changes(old->keys, first, last, false);
+    if (batch.empty())
+      return 0;
+    auto* next = new Version();
+    next->keys.reserve(old->keys.size() + batch.size());
+    std::merge(old->keys.begin(), old->keys.end(), batch.begin(), batch.end(),
+               std::back_inserter(next->keys));
+    publish(next);
+    return batch.size();
+  }
+
+  // Removes every key of the range as one update, returns how many were in
+  // the set
+  template <class It>
+  std::size_t remove_all(It first, It last) {
+    std::lock_guard lk{writer};
+    const Version* old = current.load(std::memory_order_relaxed);
+    std::vector<T> batch = changes(old->keys, first, last, true);
+    if (batch.empty())
+      return 0;
+    auto* next = new Version();
+    next->keys.reserve(old->keys.size() - batch.size());
+    std::set_difference(old->keys.begin(), old->keys.end(), batch.begin(),
+                        batch.end(), std::back_inserter(next->keys));
+    publish(next);
+    return batch.size();
+  }
+
+  // Retired versions are counted as large as the current one
+  MemoryStats memory_stats() {
+    auto guard = versions.pin();
+    const Version* version = current.load(std::memory_order_acquire);
+    MemoryStats stats;
+    stats.keys = version->keys.size();
+    stats.liveNodes = 1;
+    stats.liveBytes = sizeof(Version) + version->keys.capacity() * sizeof(T);
+    stats.retiredNodes = versions.pending();
+    stats.retiredBytes = stats.retiredNodes * stats.liveBytes;
+    return stats;
+  }
+
+ private:
+  std::atomic<Version*> current;
+  std::mutex writer;
+  Epoch::Manager<Version, 1> versions{};
+
+  // Halves the range without branching on the comparison, so the loop runs
+  // log n times whatever the keys and the compiler can use a cmov
+  template <class Keys>
+  static bool contains(const Keys& keys, const T& key) {
+    if (keys.empty())
+      return false;
+    const T* base = keys.data();
+    for (std::size_t n = keys.size(); n > 1; n -= n / 2)
+      base = base[n / 2] < key ? base + n / 2 : base;
+    base += *base < key;
+    return base != keys.data() + keys.size() && *base == key;
+  }
+
+  // Keys of the range an update changes, the ones in keys for a removal and
+  // the others for an insertion, sorted and without duplicates
+  template <class Keys, class It>
+  static std::vector<T> changes(const Keys& keys, It first, It last,
+                                bool removal) {
+    std::vector<T> batch;
+    for (; first != last; ++first) {
+      if (contains(keys, *first) == removal)
+        batch.push_back(*first);
+    }
+    std::sort(batch.begin(), batch.end());
+    batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+    return batch;
+  }
+
+  // Caller holds writer
+  void publish(Version* next) {
+    Version* old = current.exchange(next, std::memory_order_acq_rel);
+    auto guard = versions.pin();
+    versions.retire(old);
+  }
+};
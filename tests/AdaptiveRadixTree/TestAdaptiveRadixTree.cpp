@@ -0,0 +1,280 @@
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <semaphore>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "src/AdaptiveRadixTree/AdaptiveRadixTree.h"
+#include "tests/utils.h"
+
+TEST_CASE("ART Insertion sequential check") {
+  AdaptiveRadixTree<int> tree;
+  for (int i = 0; i < 100; i++)
+    REQUIRE(!tree[i]);
+  for (int i = 0; i < 100; i++)
+    REQUIRE(tree.insert(i));
+  for (int i = 0; i < 100; i++)
+    REQUIRE(tree[i]);
+}
+
+TEST_CASE("ART Deletion sequential check") {
+  SECTION("0/1 child deletion") {
+    constexpr int NUM = 1000;
+    AdaptiveRadixTree<int> tree;
+
+    for (int i = 0; i < NUM; i++)
+      REQUIRE(tree.insert(i));
+    for (int i = 0; i < NUM; i++) {
+      REQUIRE(tree.remove(i));
+      for (int k = 0; k <= i; k++)
+        REQUIRE(!tree[k]);
+      for (int k = i + 1; k < NUM; k++)
+        REQUIRE(tree[k]);
+    }
+  }
+
+  SECTION("2 children deletion") {
+    constexpr int NUM = 1000;
+    AdaptiveRadixTree<int> tree;
+
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          REQUIRE(tree.insert(mid));
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, NUM - 1);
+
+    for (int i = 0; i < NUM; i++) {
+      REQUIRE(tree.remove(i));
+      for (int k = 0; k <= i; k++)
+        REQUIRE(!tree[k]);
+      for (int k = i + 1; k < NUM; k++)
+        REQUIRE(tree[k]);
+    }
+  }
+}
+
+TEMPLATE_TEST_CASE("ART Random operations against std::set", "", int,
+                   int64_t) {
+  constexpr int NUM_OPS = 200000;
+  AdaptiveRadixTree<TestType> tree;
+  std::set<TestType> expected;
+  std::uniform_int_distribution<int> shiftDist{0, 62};
+  // Mix of small keys sharing long prefixes and keys spread over the range
+  checkRandomOps(tree, expected, NUM_OPS,
+                 [&shiftDist](std::mt19937_64& gen, int i) {
+                   const TestType key =
+                       static_cast<TestType>(gen() >> shiftDist(gen));
+                   return i % 2 == 0 ? static_cast<TestType>(key % 4096 - 2048)
+                                     : key;
+                 });
+  for (const TestType key : expected)
+    REQUIRE(tree[key]);
+}
+
+TEST_CASE("ART Extreme keys") {
+  AdaptiveRadixTree<int> tree;
+  for (int key : {std::numeric_limits<int>::min(), -1, 0, 1,
+                  std::numeric_limits<int>::max()}) {
+    REQUIRE(tree.insert(key));
+    REQUIRE(!tree.insert(key));
+  }
+  REQUIRE(tree[std::numeric_limits<int>::min()]);
+  REQUIRE(tree[std::numeric_limits<int>::max()]);
+  REQUIRE(!tree[2]);
+  REQUIRE(tree.remove(-1));
+  REQUIRE(!tree[-1]);
+  REQUIRE(tree[0]);
+}
+
+TEST_CASE("ART Linearizability Sanity Check") {
+  constexpr int NUM_ITER = 10000, NUM_INSERTION = 100;
+  std::vector<bool> arr;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    AdaptiveRadixTree<int> tree;
+    std::counting_semaphore<2> sem{0};
+
+    std::thread t1{[&]() {
+      sem.acquire();
+      for (int i = 0; i < NUM_INSERTION; i++)
+        tree.insert(i);
+    }};
+
+    std::thread t2{[&]() {
+      sem.acquire();
+      for (int i = 0; i < NUM_INSERTION; i++)
+        arr.emplace_back(!tree.remove(i));
+    }};
+
+    sem.release(2);
+    t1.join();
+    t2.join();
+
+    for (int i = 0; i < NUM_INSERTION; i++) {
+      REQUIRE(tree[i] == arr[i]);
+    }
+    arr.clear();
+  }
+}
+
+TEST_CASE("ART Insertion - Insertion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 10, NUM_ELEMS_PER_THREAD = 1000;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    AdaptiveRadixTree<int> tree;
+
+    const auto insertFunc = [&tree](int start, int end) {
+      for (int k = start; k < end; k++)
+        tree.insert(k);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(insertFunc, thread * NUM_ELEMS_PER_THREAD,
+                           (thread + 1) * NUM_ELEMS_PER_THREAD);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS; thread++)
+      threads[thread].join();
+    for (int num = 0; num < NUM_THREADS * NUM_ELEMS_PER_THREAD; num++)
+      REQUIRE(tree[num]);
+  }
+}
+
+TEST_CASE("ART Deletion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 50, NUM_ELEMS_PER_THREAD = 400,
+                MOD = 64;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    AdaptiveRadixTree<int> tree;
+    // Balanced tree insertion
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          tree.insert(mid);
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, MOD * NUM_ELEMS_PER_THREAD - 1);
+
+    const auto deleteFunc = [&tree](int start) {
+      for (int k = 0; k < NUM_ELEMS_PER_THREAD; k++) {
+        int cur = start + MOD * k;
+        tree.remove(cur);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(deleteFunc, thread);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS; thread++)
+      threads[thread].join();
+
+    for (int num = 0; num < NUM_THREADS * NUM_ELEMS_PER_THREAD; num++) {
+      if (num % MOD < NUM_THREADS)
+        REQUIRE(!tree[num]);
+      else
+        REQUIRE(tree[num]);
+    }
+  }
+}
+
+TEST_CASE("ART Insertion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 64, OFFSET = 16384;
+  constexpr int DELETIONS_PER_THREAD = OFFSET / NUM_THREADS;
+  constexpr int INSERTIONS_PER_THREAD = 500;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    AdaptiveRadixTree<int> tree;
+    // Balanced tree insertion
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          tree.insert(mid);
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, OFFSET - 1);
+
+    const auto deleteFunc = [&tree, &DELETIONS_PER_THREAD](int start) {
+      for (int k = start * DELETIONS_PER_THREAD,
+               e = (start + 1) * DELETIONS_PER_THREAD;
+           k < e; k++) {
+        tree.remove(k);
+      }
+    };
+
+    const auto insertionFunc = [&tree, &OFFSET,
+                                &INSERTIONS_PER_THREAD](int start) {
+      for (int k = 0; k < INSERTIONS_PER_THREAD; k++) {
+        tree.insert(OFFSET + start * INSERTIONS_PER_THREAD + k);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS * 2);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(deleteFunc, thread);
+      threads.emplace_back(insertionFunc, thread);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS * 2; thread++)
+      threads[thread].join();
+
+    for (int num = 0; num < OFFSET; num++)
+      REQUIRE(!tree[num]);
+    for (int num = OFFSET; num < OFFSET + INSERTIONS_PER_THREAD * NUM_THREADS;
+         num++)
+      REQUIRE(tree[num]);
+  }
+}
+
+TEMPLATE_TEST_CASE("ART Memory stats", "", int, int64_t) {
+  constexpr int NUM = 10000;
+  AdaptiveRadixTree<TestType> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  const MemoryStats stats = tree.memory_stats();
+  REQUIRE(stats.keys == NUM / 2);
+  REQUIRE(stats.liveBytes > 0);
+  // Growing the nodes on the way retired the smaller ones
+  REQUIRE(stats.retiredNodes > 0);
+}
+TEST_CASE("ART Stats next to updates") {
+  constexpr int NUM_THREADS = 4, KEYS = 2000, ROUNDS = 20;
+  AdaptiveRadixTree<int> tree;
+  insertEvenKeys(tree, KEYS);
+  // Inserts grow and replace the nodes the walk counts
+  checkOddKeyRace(tree, NUM_THREADS, KEYS, ROUNDS,
+                  [&tree](const std::atomic<int>& running) {
+                    while (running > 0)
+                      tree.memory_stats();
+                  });
+  REQUIRE(tree.memory_stats().keys == KEYS / 2);
+}
@@ -0,0 +1,299 @@
+#include <functional>
+#include <random>
+#include <semaphore>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "src/BLinkTree/BLinkTree.h"
+#include "tests/utils.h"
+
+// Small nodes so that the tests split on several levels
+using SmallBLinkTree = BLinkTree<int, 2 * BLink::CACHE_LINE_SIZE>;
+
+TEST_CASE("BLink Insertion sequential check") {
+  SmallBLinkTree tree;
+  for (int i = 0; i < 100; i++)
+    REQUIRE(!tree[i]);
+  for (int i = 0; i < 100; i++)
+    REQUIRE(tree.insert(i));
+  for (int i = 0; i < 100; i++)
+    REQUIRE(tree[i]);
+}
+
+TEST_CASE("BLink Deletion sequential check") {
+  SECTION("0/1 child deletion") {
+    constexpr int NUM = 1000;
+    SmallBLinkTree tree;
+
+    for (int i = 0; i < NUM; i++)
+      REQUIRE(tree.insert(i));
+    for (int i = 0; i < NUM; i++) {
+      REQUIRE(tree.remove(i));
+      for (int k = 0; k <= i; k++)
+        REQUIRE(!tree[k]);
+      for (int k = i + 1; k < NUM; k++)
+        REQUIRE(tree[k]);
+    }
+  }
+
+  SECTION("2 children deletion") {
+    constexpr int NUM = 1000;
+    SmallBLinkTree tree;
+
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          REQUIRE(tree.insert(mid));
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, NUM - 1);
+
+    for (int i = 0; i < NUM; i++) {
+      REQUIRE(tree.remove(i));
+      for (int k = 0; k <= i; k++)
+        REQUIRE(!tree[k]);
+      for (int k = i + 1; k < NUM; k++)
+        REQUIRE(tree[k]);
+    }
+  }
+}
+
+TEST_CASE("BLink Random operations against std::set") {
+  constexpr int NUM_OPS = 200000, KEY_RANGE = 20000;
+  BLinkTree<int> tree;
+  std::set<int> expected;
+  checkRandomOps(tree, expected, NUM_OPS, uniformKeys(KEY_RANGE));
+  for (int key = 0; key < KEY_RANGE; key++)
+    REQUIRE(tree[key] == expected.contains(key));
+}
+
+TEST_CASE("BLink SIMD node search matches scalar search") {
+  const auto check = []<class T>(T) {
+    for (std::size_t n = 0; n <= 70; n++) {
+      std::vector<T> keys(n);
+      for (std::size_t i = 0; i < n; i++)
+        keys[i] = static_cast<T>(3 * i) - 50;
+      for (T key = -60; key < static_cast<T>(3 * n); key++) {
+        REQUIRE(BLink::SimdSearch<T>::lowerBound(keys.data(), n, key) ==
+                BLink::ScalarSearch<T>::lowerBound(keys.data(), n, key));
+        REQUIRE(BLink::SimdSearch<T>::upperBound(keys.data(), n, key) ==
+                BLink::ScalarSearch<T>::upperBound(keys.data(), n, key));
+      }
+    }
+  };
+  check(int32_t{});
+  check(int64_t{});
+}
+
+TEST_CASE("BLink 64-bit keys against std::set") {
+  constexpr int NUM_OPS = 200000;
+  constexpr int64_t KEY_RANGE = 20000, STRIDE = int64_t{1} << 40;
+  BLinkTree<int64_t, 2 * BLink::CACHE_LINE_SIZE> tree;
+  std::set<int64_t> expected;
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int64_t> keyDist{-KEY_RANGE, KEY_RANGE};
+  std::uniform_int_distribution<int> opDist{0, 2};
+
+  for (int i = 0; i < NUM_OPS; i++) {
+    int64_t key = keyDist(gen) * STRIDE;
+    switch (opDist(gen)) {
+      case 0:
+        REQUIRE(tree.insert(key) == expected.insert(key).second);
+        break;
+      case 1:
+        REQUIRE(tree.remove(key) == (expected.erase(key) == 1));
+        break;
+      default:
+        REQUIRE(tree[key] == expected.contains(key));
+    }
+  }
+}
+
+TEST_CASE("BLink Linearizability Sanity Check") {
+  constexpr int NUM_ITER = 10000, NUM_INSERTION = 100;
+  std::vector<bool> arr;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    SmallBLinkTree tree;
+    std::counting_semaphore<2> sem{0};
+
+    std::thread t1{[&]() {
+      sem.acquire();
+      for (int i = 0; i < NUM_INSERTION; i++)
+        tree.insert(i);
+    }};
+
+    std::thread t2{[&]() {
+      sem.acquire();
+      for (int i = 0; i < NUM_INSERTION; i++)
+        arr.emplace_back(!tree.remove(i));
+    }};
+
+    sem.release(2);
+    t1.join();
+    t2.join();
+
+    for (int i = 0; i < NUM_INSERTION; i++) {
+      REQUIRE(tree[i] == arr[i]);
+    }
+    arr.clear();
+  }
+}
+
+TEST_CASE("BLink Insertion - Insertion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 10, NUM_ELEMS_PER_THREAD = 1000;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    SmallBLinkTree tree;
+
+    const auto insertFunc = [&tree](int start, int end) {
+      for (int k = start; k < end; k++)
+        tree.insert(k);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(insertFunc, thread * NUM_ELEMS_PER_THREAD,
+                           (thread + 1) * NUM_ELEMS_PER_THREAD);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS; thread++)
+      threads[thread].join();
+    for (int num = 0; num < NUM_THREADS * NUM_ELEMS_PER_THREAD; num++)
+      REQUIRE(tree[num]);
+  }
+}
+
+TEST_CASE("BLink Deletion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 50, NUM_ELEMS_PER_THREAD = 400,
+                MOD = 64;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    SmallBLinkTree tree;
+    // Balanced tree insertion
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          tree.insert(mid);
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, MOD * NUM_ELEMS_PER_THREAD - 1);
+
+    const auto deleteFunc = [&tree](int start) {
+      for (int k = 0; k < NUM_ELEMS_PER_THREAD; k++) {
+        int cur = start + MOD * k;
+        tree.remove(cur);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(deleteFunc, thread);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS; thread++)
+      threads[thread].join();
+
+    for (int num = 0; num < NUM_THREADS * NUM_ELEMS_PER_THREAD; num++) {
+      if (num % MOD < NUM_THREADS)
+        REQUIRE(!tree[num]);
+      else
+        REQUIRE(tree[num]);
+    }
+  }
+}
+
+TEST_CASE("BLink Insertion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 64, OFFSET = 16384;
+  constexpr int DELETIONS_PER_THREAD = OFFSET / NUM_THREADS;
+  constexpr int INSERTIONS_PER_THREAD = 500;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    SmallBLinkTree tree;
+    // Balanced tree insertion
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          tree.insert(mid);
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, OFFSET - 1);
+
+    const auto deleteFunc = [&tree, &DELETIONS_PER_THREAD](int start) {
+      for (int k = start * DELETIONS_PER_THREAD,
+               e = (start + 1) * DELETIONS_PER_THREAD;
+           k < e; k++) {
+        tree.remove(k);
+      }
+    };
+
+    const auto insertionFunc = [&tree, &OFFSET,
+                                &INSERTIONS_PER_THREAD](int start) {
+      for (int k = 0; k < INSERTIONS_PER_THREAD; k++) {
+        tree.insert(OFFSET + start * INSERTIONS_PER_THREAD + k);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS * 2);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(deleteFunc, thread);
+      threads.emplace_back(insertionFunc, thread);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS * 2; thread++)
+      threads[thread].join();
+
+    for (int num = 0; num < OFFSET; num++)
+      REQUIRE(!tree[num]);
+    for (int num = OFFSET; num < OFFSET + INSERTIONS_PER_THREAD * NUM_THREADS;
+         num++)
+      REQUIRE(tree[num]);
+  }
+}
+
+TEST_CASE("BLink Memory stats") {
+  constexpr int NUM = 10000;
+  SmallBLinkTree tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  const MemoryStats stats = tree.memory_stats();
+  REQUIRE(stats.keys == NUM / 2);
+  REQUIRE(stats.liveNodes > NUM / SmallBLinkTree::Leaf::CAPACITY);
+  REQUIRE(stats.liveBytes % (2 * BLink::CACHE_LINE_SIZE) == 0);
+  REQUIRE(stats.retiredNodes == 0);
+}
+TEST_CASE("BLink Stats next to updates") {
+  constexpr int NUM_THREADS = 4, KEYS = 2000, ROUNDS = 20;
+  SmallBLinkTree tree;
+  insertEvenKeys(tree, KEYS);
+  // Inserts split the nodes the walk counts
+  checkOddKeyRace(tree, NUM_THREADS, KEYS, ROUNDS,
+                  [&tree](const std::atomic<int>& running) {
+                    while (running > 0)
+                      tree.memory_stats();
+                  });
+  REQUIRE(tree.memory_stats().keys == KEYS / 2);
+}
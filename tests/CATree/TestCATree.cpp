@@ -0,0 +1,129 @@
+#include <atomic>
+#include <set>
+
+#include "catch.hpp"
+#include "src/CATree/CATree.h"
+#include "tests/utils.h"
+
+// Base node of key, as the tree would find it
+CA::BaseNode<int>* baseOf(CATree<int>& tree, int key) {
+  CA::Node<int>* node = tree.root.load();
+  while (!node->isBase) {
+    auto* route = static_cast<CA::RouteNode<int>*>(node);
+    node = key < route->key ? route->left.load() : route->right.load();
+  }
+  return static_cast<CA::BaseNode<int>*>(node);
+}
+
+TEST_CASE("CA Insertion sequential check") {
+  constexpr int NUM = 1000;
+  CATree<int> tree;
+
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(!tree[i]);
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(tree.insert(i));
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(!tree.insert(i));
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(tree[i]);
+}
+
+TEST_CASE("CA Deletion sequential check") {
+  constexpr int NUM = 1000;
+  CATree<int> tree;
+
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(tree.insert(i));
+  for (int i = 0; i < NUM; i++) {
+    REQUIRE(tree.remove(i));
+    REQUIRE(!tree.remove(i));
+    REQUIRE(!tree[i]);
+    if (i + 1 < NUM)
+      REQUIRE(tree[i + 1]);
+  }
+}
+
+TEST_CASE("CA Contended base nodes split and join back") {
+  constexpr int NUM = 1000;
+  CATree<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  REQUIRE(tree.root.load()->isBase);
+
+  // As if the lock had been contended often enough to be split
+  baseOf(tree, 0)->statistics = CA::SPLIT_ABOVE + CA::CONTENDED;
+  REQUIRE(tree[0]);
+  REQUIRE(!tree.root.load()->isBase);
+  REQUIRE(static_cast<CA::RouteNode<int>*>(tree.root.load())->key == NUM / 2);
+  REQUIRE(tree.memory_stats().liveNodes == 3);
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(tree[i]);
+
+  // Uncontended operations on one half join it with the other
+  for (int i = 0; i <= -CA::JOIN_BELOW; i++)
+    REQUIRE(!tree[NUM]);
+  REQUIRE(tree.root.load()->isBase);
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(tree[i]);
+
+  const MemoryStats stats = tree.memory_stats();
+  REQUIRE(stats.keys == NUM);
+  REQUIRE(stats.liveNodes == 1);
+  REQUIRE(stats.retiredNodes == 4);
+}
+
+TEST_CASE("CA Random operations against std::set") {
+  constexpr int NUM_OPS = 200000, KEY_RANGE = 2000, SPLIT_EVERY = 100;
+  CATree<int> tree;
+  std::set<int> expected;
+  // Splits keep up with the joins of the single thread
+  checkRandomOps(tree, expected, NUM_OPS, uniformKeys(KEY_RANGE),
+                 [&tree](int i, int key) {
+                   if (i % SPLIT_EVERY == 0)
+                     baseOf(tree, key)->statistics =
+                         CA::SPLIT_ABOVE + CA::CONTENDED;
+                 });
+  REQUIRE(tree.memory_stats().keys == expected.size());
+}
+
+TEST_CASE("CA Insertion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 16, KEYS = 4096, ROUNDS = 20;
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    CATree<int> tree;
+    insertEvenKeys(tree, KEYS);
+    // Real contention is rare on few cores, mark base nodes as contended so
+    // that splits race with the joins of the updating threads
+    checkOddKeyRace(tree, NUM_THREADS, KEYS, ROUNDS,
+                    [&tree](const std::atomic<int>& running) {
+                      for (int key = 0; running > 0;
+                           key = (key + 997) % KEYS) {
+                        CA::BaseNode<int>* base = baseOf(tree, key);
+                        std::lock_guard lk{base->mut};
+                        base->statistics = CA::SPLIT_ABOVE + CA::CONTENDED;
+                      }
+                    });
+    REQUIRE(tree.memory_stats().keys == KEYS / 2);
+  }
+}
+
+TEST_CASE("CA Stats next to updates") {
+  constexpr int NUM_THREADS = 4, KEYS = 2000, ROUNDS = 20;
+  CATree<int> tree;
+  insertEvenKeys(tree, KEYS);
+  // Splits move keys out of the base nodes the walk reaches
+  checkOddKeyRace(tree, NUM_THREADS, KEYS, ROUNDS,
+                  [&tree](const std::atomic<int>& running) {
+                    for (int key = 0; running > 0;
+                         key = (key + 997) % KEYS) {
+                      CA::BaseNode<int>* base = baseOf(tree, key);
+                      {
+                        std::lock_guard lk{base->mut};
+                        base->statistics = CA::SPLIT_ABOVE + CA::CONTENDED;
+                      }
+                      tree.memory_stats();
+                    }
+                  });
+  REQUIRE(tree.memory_stats().keys == KEYS / 2);
+}
@@ -1,4 +1,7 @@
 #include <functional>
+#include <iterator>
+#include <random>
+#include <set>
 #include <thread>
 #include <vector>
 
@@ -185,4 +188,79 @@ TEST_CASE("CGLBST Insertion - Deletion Race") {
          num++)
       REQUIRE(tree[num]);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("CGL Memory stats") {
+  constexpr int NUM = 1000;
+  CGLBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  const MemoryStats stats = tree.memory_stats();
+  REQUIRE(stats.keys == NUM / 2);
+  REQUIRE(stats.liveNodes == NUM / 2);
+  // Removed nodes are not freed
+  REQUIRE(stats.retiredNodes == NUM / 2);
+}
+
+TEST_CASE("CGL Height") {
+  constexpr int NUM = 1000;
+  CGLBST<int> tree;
+  REQUIRE(tree.height() == 0);
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  REQUIRE(tree.height() == NUM);
+}
+
+TEST_CASE("CGL Shape stats") {
+  CGLBST<int> tree;
+  for (const int key : {3, 1, 5, 0, 2, 4, 6})
+    tree.insert(key);
+
+  ShapeStats shape = tree.shape_stats();
+  REQUIRE(shape.height == 3);
+  REQUIRE(shape.keys == 7);
+  REQUIRE(shape.leafDepths == std::vector<std::size_t>{0, 0, 0, 4});
+  REQUIRE(shape.maxImbalance == 0);
+  REQUIRE(shape.averagePathLength() == Approx(17.0 / 7));
+
+  tree.insert(7);
+  tree.insert(8);
+  shape = tree.shape_stats();
+  REQUIRE(shape.height == 5);
+  REQUIRE(shape.leaves() == 4);
+  // 6 has only a right subtree of height 2
+  REQUIRE(shape.maxImbalance == 2);
+}
+
+TEST_CASE("CGL Order statistics") {
+  constexpr int NUM_OPS = 20000, KEY_RANGE = 500;
+  CGLBST<int> tree;
+  std::set<int> expected;
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> keyDist{0, KEY_RANGE - 1}, opDist{0, 1};
+
+  REQUIRE(tree.size() == 0);
+  REQUIRE(tree.rank(0) == 0);
+  REQUIRE(!tree.select(0));
+  for (int i = 0; i < NUM_OPS; i++) {
+    int key = keyDist(gen);
+    if (opDist(gen) == 0)
+      REQUIRE(tree.insert(key) == expected.insert(key).second);
+    else
+      REQUIRE(tree.remove(key) == (expected.erase(key) == 1));
+    REQUIRE(tree.size() == expected.size());
+  }
+
+  for (int key = -1; key <= KEY_RANGE; key++) {
+    const auto below =
+        std::distance(expected.begin(), expected.lower_bound(key));
+    REQUIRE(tree.rank(key) == static_cast<std::size_t>(below));
+  }
+  std::size_t k = 0;
+  for (const int key : expected)
+    REQUIRE(tree.select(k++) == key);
+  REQUIRE(!tree.select(k));
+}
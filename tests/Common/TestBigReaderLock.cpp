@@ -0,0 +1,70 @@
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "src/Common/BigReaderLock.h"
+
+TEST_CASE("BigReader Readers share the lock") {
+  BigReaderLock lock;
+  std::shared_lock lk{lock};
+
+  bool acquired = false;
+  std::thread reader{[&lock, &acquired] {
+    acquired = lock.try_lock_shared();
+    if (acquired)
+      lock.unlock_shared();
+  }};
+  reader.join();
+  REQUIRE(acquired);
+  REQUIRE(!lock.try_lock());
+
+  lk.unlock();
+  REQUIRE(lock.try_lock());
+  std::thread blocked{[&lock, &acquired] {
+    acquired = lock.try_lock_shared() || lock.try_lock();
+  }};
+  blocked.join();
+  REQUIRE(!acquired);
+  lock.unlock();
+}
+
+TEST_CASE("BigReader Writers exclude readers and each other") {
+  constexpr int NUM_READERS = 8, NUM_WRITERS = 4, WRITES = 20000;
+  BigReaderLock lock;
+  // Only ever written together under the lock
+  int first = 0, second = 0;
+  std::atomic<bool> done{false};
+  std::atomic<int> torn{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < NUM_READERS; t++) {
+    threads.emplace_back([&] {
+      while (!done.load()) {
+        std::shared_lock lk{lock};
+        torn += first != second;
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < NUM_WRITERS; t++) {
+    writers.emplace_back([&] {
+      for (int i = 0; i < WRITES; i++) {
+        std::unique_lock lk{lock};
+        first++;
+        second++;
+      }
+    });
+  }
+  for (std::thread& writer : writers)
+    writer.join();
+  done.store(true);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  REQUIRE(torn == 0);
+  REQUIRE(first == NUM_WRITERS * WRITES);
+  REQUIRE(second == NUM_WRITERS * WRITES);
+}
@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "src/Common/NumaAllocator.h"
+
+namespace {
+struct Small : Numa::Allocated {
+  int value;
+  explicit Small(int value) : value{value} {}
+};
+
+struct alignas(64) Aligned : Numa::Allocated {
+  char bytes[192];
+};
+
+struct Large : Numa::Allocated {
+  char bytes[8192];
+};
+}  // namespace
+
+TEST_CASE("Numa Allocated objects are distinct and aligned") {
+  std::vector<Small*> smalls;
+  std::vector<Aligned*> aligned;
+  for (int i = 0; i < 1000; i++) {
+    smalls.push_back(new Small(i));
+    aligned.push_back(new Aligned());
+  }
+  for (int i = 0; i < 1000; i++) {
+    REQUIRE(smalls[i]->value == i);
+    REQUIRE(reinterpret_cast<uintptr_t>(aligned[i]) % 64 == 0);
+  }
+  std::set<Small*> distinct(smalls.begin(), smalls.end());
+  REQUIRE(distinct.size() == smalls.size());
+
+  for (Small* small : smalls)
+    delete small;
+  for (Aligned* a : aligned)
+    delete a;
+
+  auto* large = new Large();
+  large->bytes[sizeof(large->bytes) - 1] = 1;
+  delete large;
+}
+
+TEST_CASE("Numa Objects freed by another thread") {
+  std::vector<Small*> smalls;
+  for (int i = 0; i < 1000; i++)
+    smalls.push_back(new Small(i));
+
+  std::thread freer{[&smalls] {
+    for (Small* small : smalls)
+      delete small;
+  }};
+  freer.join();
+
+  // Freed blocks are handed out again
+  for (int i = 0; i < 1000; i++) {
+    smalls[i] = new Small(i);
+    REQUIRE(smalls[i]->value == i);
+  }
+  for (Small* small : smalls)
+    delete small;
+}
+
+TEST_CASE("Numa Scoped placement") {
+  Numa::setPlacement(Numa::Placement::LOCAL);
+  REQUIRE(Numa::placement() == Numa::Placement::LOCAL);
+  {
+    Numa::ScopedPlacement outer{Numa::Placement::INTERLEAVE};
+    REQUIRE(Numa::placement() == Numa::Placement::INTERLEAVE);
+    delete new Small(0);
+    {
+      Numa::ScopedPlacement inner{Numa::Placement::LOCAL};
+      REQUIRE(Numa::placement() == Numa::Placement::LOCAL);
+    }
+    REQUIRE(Numa::placement() == Numa::Placement::INTERLEAVE);
+  }
+  REQUIRE(Numa::placement() == Numa::Placement::LOCAL);
+  REQUIRE(Numa::currentNode() < Numa::nodeCount());
+}
+
+TEST_CASE("Numa Allocator in a std container") {
+  std::set<int, std::less<int>, Numa::Allocator<int>> set;
+  for (int i = 0; i < 1000; i++)
+    set.insert(i);
+  for (int i = 0; i < 1000; i += 2)
+    set.erase(i);
+  REQUIRE(set.size() == 500);
+  REQUIRE(*set.begin() == 1);
+}
@@ -0,0 +1,60 @@
+#include <atomic>
+#include <set>
+
+#include "catch.hpp"
+#include "src/CoarseGrainedLockingBST/CGLBST.h"
+#include "src/FilteredBST/FilteredBST.h"
+#include "tests/utils.h"
+
+TEST_CASE("Filtered Bloom filter") {
+  constexpr int NUM = 10000;
+  CountingBloomFilter<int> filter{NUM};
+  for (int i = 0; i < NUM; i++)
+    filter.add(i);
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(filter.mayContain(i));
+
+  int falsePositives = 0;
+  for (int i = NUM; i < 2 * NUM; i++)
+    falsePositives += filter.mayContain(i);
+  REQUIRE(falsePositives < NUM / 10);
+
+  // Removing every key leaves every counter at zero
+  for (int i = 0; i < NUM; i++)
+    filter.remove(i);
+  for (int i = 0; i < 2 * NUM; i++)
+    REQUIRE(!filter.mayContain(i));
+}
+
+TEST_CASE("Filtered Saturated counters stay set") {
+  CountingBloomFilter<int> filter{1};
+  for (int i = 0; i < 300; i++)
+    filter.add(1);
+  for (int i = 0; i < 300; i++)
+    filter.remove(1);
+  REQUIRE(filter.mayContain(1));
+}
+
+TEST_CASE("Filtered Random operations against std::set") {
+  constexpr int NUM_OPS = 200000, KEY_RANGE = 20000;
+  FilteredBST<int> tree{1};
+  std::set<int> expected;
+  checkRandomOps(tree, expected, NUM_OPS, uniformKeys(KEY_RANGE));
+}
+
+TEST_CASE("Filtered No false negatives under concurrent updates") {
+  constexpr int NUM_THREADS = 4, KEYS = 4096, ROUNDS = 20;
+  FilteredBST<int, CGLBST<int>> tree{KEYS};
+  insertEvenKeys(tree, KEYS);
+  // A reader keeps looking up the even keys while the writers run
+  std::atomic<int> missed{0};
+  checkOddKeyRace(tree, NUM_THREADS, KEYS, ROUNDS,
+                  [&tree, &missed](const std::atomic<int>& running) {
+                    while (running > 0) {
+                      for (int i = 0; i < KEYS; i += 2)
+                        missed += !tree[i];
+                    }
+                  });
+  REQUIRE(missed == 0);
+  REQUIRE(tree.memory_stats().keys == KEYS / 2);
+}
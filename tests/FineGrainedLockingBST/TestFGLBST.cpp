@@ -1,5 +1,7 @@
+#include <atomic>
 #include <functional>
 #include <iostream>
+#include <shared_mutex>
 #include <thread>
 #include <vector>
 
@@ -186,4 +188,97 @@ TEST_CASE("FGLBST Insertion - Deletion Race") {
          num++)
       REQUIRE(tree[num]);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("FGL Updates only share the path") {
+  constexpr int NUM = 1000;
+  FGLBST<int> tree;
+  tree.insert(NUM);
+
+  // Would block forever if writers locked the path exclusively
+  std::shared_lock lk{tree.root->mut};
+  std::thread writer{[&tree] {
+    for (int i = 0; i < NUM; i++)
+      tree.insert(i);
+    for (int i = 0; i < NUM; i += 2)
+      tree.remove(i);
+  }};
+  writer.join();
+  lk.unlock();
+
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(tree[i] == (i % 2 == 1));
+  REQUIRE(tree[NUM]);
+}
+
+TEST_CASE("FGL Memory stats") {
+  constexpr int NUM = 1000;
+  FGLBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  const MemoryStats stats = tree.memory_stats();
+  REQUIRE(stats.keys == NUM / 2);
+  REQUIRE(stats.liveNodes == NUM / 2 + 2);
+  // Removed nodes are not freed
+  REQUIRE(stats.retiredNodes == NUM / 2);
+}
+TEST_CASE("FGL Lock profile") {
+  constexpr int NUM = 8;
+  FGLBST<int> tree;
+  LockProfiler::reset();
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+
+  const LockProfiler::Profile profile = LockProfiler::collect();
+  if (!LockProfiler::ENABLED) {
+    for (const LockProfiler::LevelStats& stats : profile)
+      REQUIRE(stats.acquisitions == 0);
+    return;
+  }
+  // Every insertion locks both sentinels, then the chain of smaller keys, and
+  // locks the last node of the chain again to write to it. The first one
+  // writes to the lower sentinel.
+  REQUIRE(profile[LockProfiler::level(0)].acquisitions == NUM);
+  REQUIRE(profile[LockProfiler::level(1)].acquisitions == NUM + 1);
+  uint64_t acquisitions = 0;
+  for (const LockProfiler::LevelStats& stats : profile)
+    acquisitions += stats.acquisitions;
+  REQUIRE(acquisitions == 3 * NUM + NUM * (NUM - 1) / 2);
+  // Only the last insertion reaches depth 8 and writes there
+  REQUIRE(profile[LockProfiler::level(8)].acquisitions == 2);
+}
+
+TEST_CASE("FGL Stats next to updates") {
+  constexpr int NUM_THREADS = 4, KEYS = 2000, ROUNDS = 20;
+  FGLBST<int> tree;
+  for (int i = 0; i < KEYS; i += 2)
+    tree.insert(i);
+
+  std::atomic<bool> done{false};
+  std::thread reader{[&tree, &done] {
+    while (!done) {
+      tree.shape_stats();
+      tree.memory_stats();
+    }
+  }};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < NUM_THREADS; t++) {
+    threads.emplace_back([&tree, t] {
+      for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 1 + 2 * t; i < KEYS; i += 2 * NUM_THREADS)
+          tree.insert(i);
+        for (int i = 1 + 2 * t; i < KEYS; i += 2 * NUM_THREADS)
+          tree.remove(i);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  done = true;
+  reader.join();
+
+  REQUIRE(tree.shape_stats().keys == KEYS / 2);
+}
@@ -0,0 +1,26 @@
+#include <set>
+
+#include "catch.hpp"
+#include "src/CGLBBST/CGLBBST.h"
+#include "src/FlatCombiningBST/FlatCombiningBST.h"
+#include "tests/utils.h"
+
+TEMPLATE_TEST_CASE("FlatCombining Random operations against std::set", "",
+                   FlatCombiningBST<int>,
+                   (FlatCombiningBST<int, CGLBBST<int>>)) {
+  constexpr int NUM_OPS = 200000, KEY_RANGE = 20000;
+  TestType tree;
+  std::set<int> expected;
+  checkRandomOps(tree, expected, NUM_OPS, uniformKeys(KEY_RANGE));
+  REQUIRE(tree.memory_stats().keys == expected.size());
+}
+
+TEMPLATE_TEST_CASE("FlatCombining Insertion - Deletion Race", "",
+                   FlatCombiningBST<int>,
+                   (FlatCombiningBST<int, CGLBBST<int>>)) {
+  constexpr int NUM_THREADS = 64, KEYS = 4096, ROUNDS = 20;
+  TestType tree;
+  insertEvenKeys(tree, KEYS);
+  checkOddKeyRace(tree, NUM_THREADS, KEYS, ROUNDS);
+  REQUIRE(tree.memory_stats().keys == KEYS / 2);
+}
@@ -0,0 +1,123 @@
+#include <atomic>
+#include <bit>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "src/CGLBBST/CGLBBST.h"
+#include "src/CoarseGrainedLockingBST/CGLBST.h"
+#include "src/FreezableBST/EytzingerSet.h"
+#include "src/FreezableBST/FreezableBST.h"
+
+TEST_CASE("Eytzinger Lookups of every size") {
+  constexpr int MAX_SIZE = 300;
+
+  for (int size = 0; size <= MAX_SIZE; size++) {
+    // Even keys are present, odd ones fall between them or outside
+    std::vector<int> keys;
+    for (int i = 0; i < size; i++)
+      keys.push_back(2 * i);
+    EytzingerSet<int> set{keys};
+
+    REQUIRE(set.size() == static_cast<std::size_t>(size));
+    for (int key = -1; key <= 2 * size; key++)
+      REQUIRE(set[key] == (key >= 0 && key % 2 == 0 && key < 2 * size));
+
+    std::vector<int> levels;
+    set.for_each_level_order([&levels](int key) { levels.push_back(key); });
+    REQUIRE(std::set<int>(levels.begin(), levels.end()) ==
+            std::set<int>(keys.begin(), keys.end()));
+    const ShapeStats shape = set.shape_stats();
+    REQUIRE(shape.keys == static_cast<std::size_t>(size));
+    REQUIRE(static_cast<unsigned>(shape.height) ==
+            std::bit_width(static_cast<unsigned>(size)));
+  }
+}
+
+TEMPLATE_TEST_CASE("Freezable Freezing keeps the keys", "", NatarajanBST<int>,
+                   CGLBST<int>, CGLBBST<int>) {
+  constexpr int NUM_OPS = 20000, KEY_RANGE = 2000, ROUNDS = 5;
+  FreezableBST<int, TestType> tree;
+  std::set<int> expected;
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> keyDist{0, KEY_RANGE - 1}, opDist{0, 1};
+
+  for (int round = 0; round < ROUNDS; round++) {
+    for (int i = 0; i < NUM_OPS; i++) {
+      int key = keyDist(gen);
+      if (opDist(gen) == 0)
+        REQUIRE(tree.insert(key) == expected.insert(key).second);
+      else
+        REQUIRE(tree.remove(key) == (expected.erase(key) == 1));
+    }
+
+    tree.freeze();
+    REQUIRE(tree.is_frozen());
+    for (int key = -1; key <= KEY_RANGE; key++)
+      REQUIRE(tree[key] == (expected.count(key) == 1));
+    REQUIRE(tree.memory_stats().keys == expected.size());
+
+    tree.thaw();
+    REQUIRE(!tree.is_frozen());
+    for (int key = -1; key <= KEY_RANGE; key++)
+      REQUIRE(tree[key] == (expected.count(key) == 1));
+  }
+}
+
+TEST_CASE("Freezable Updates fail while frozen") {
+  FreezableBST<int> tree;
+  tree.insert(1);
+  tree.freeze();
+
+  REQUIRE(!tree.insert(2));
+  REQUIRE(!tree.remove(1));
+  REQUIRE(tree[1]);
+  REQUIRE(!tree[2]);
+
+  tree.thaw();
+  REQUIRE(tree.insert(2));
+  REQUIRE(tree.remove(1));
+  REQUIRE(!tree[1]);
+  REQUIRE(tree[2]);
+}
+
+TEST_CASE("Freezable Thawing balances the tree") {
+  constexpr int NUM = 1023;
+  FreezableBST<int, CGLBST<int>> tree;
+
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  REQUIRE(tree.shape_stats().height == NUM);
+
+  tree.freeze();
+  REQUIRE(tree.shape_stats().height == 10);
+  tree.thaw();
+  REQUIRE(tree.shape_stats().height == 10);
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(tree[i]);
+}
+
+TEST_CASE("Freezable Concurrent lookups while frozen") {
+  constexpr int NUM_THREADS = 8, KEYS = 4096, ROUNDS = 20;
+  FreezableBST<int> tree;
+  for (int i = 0; i < KEYS; i += 2)
+    tree.insert(i);
+  tree.freeze();
+
+  std::atomic<int> failed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < NUM_THREADS; t++) {
+    threads.emplace_back([&tree, &failed, t] {
+      for (int round = 0; round < ROUNDS; round++) {
+        for (int i = t; i < KEYS; i += NUM_THREADS)
+          failed += tree[i] != (i % 2 == 0);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  REQUIRE(failed == 0);
+}
@@ -0,0 +1,292 @@
+#include <atomic>
+#include <functional>
+#include <semaphore>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "src/HashIndexedBST/HashIndexedBST.h"
+#include "tests/utils.h"
+
+TEST_CASE("HashIndexed Insertion sequential check") {
+  HashIndexedBST<int> tree{1};
+  for (int i = 0; i < 100; i++)
+    REQUIRE(!tree[i]);
+  for (int i = 0; i < 100; i++)
+    REQUIRE(tree.insert(i));
+  for (int i = 0; i < 100; i++)
+    REQUIRE(tree[i]);
+}
+
+TEST_CASE("HashIndexed Deletion sequential check") {
+  SECTION("0/1 child deletion") {
+    constexpr int NUM = 1000;
+    HashIndexedBST<int> tree{1};
+
+    for (int i = 0; i < NUM; i++)
+      REQUIRE(tree.insert(i));
+    for (int i = 0; i < NUM; i++) {
+      REQUIRE(tree.remove(i));
+      for (int k = 0; k <= i; k++)
+        REQUIRE(!tree[k]);
+      for (int k = i + 1; k < NUM; k++)
+        REQUIRE(tree[k]);
+    }
+  }
+
+  SECTION("2 children deletion") {
+    constexpr int NUM = 1000;
+    HashIndexedBST<int> tree{1};
+
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          REQUIRE(tree.insert(mid));
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, NUM - 1);
+
+    for (int i = 0; i < NUM; i++) {
+      REQUIRE(tree.remove(i));
+      for (int k = 0; k <= i; k++)
+        REQUIRE(!tree[k]);
+      for (int k = i + 1; k < NUM; k++)
+        REQUIRE(tree[k]);
+    }
+  }
+}
+
+TEST_CASE("HashIndexed Random operations against std::set") {
+  constexpr int NUM_OPS = 200000, KEY_RANGE = 20000;
+  HashIndexedBST<int> tree{1};
+  std::set<int> expected;
+  checkRandomOps(tree, expected, NUM_OPS, uniformKeys(KEY_RANGE));
+  for (int key = 0; key < KEY_RANGE; key++) {
+    REQUIRE(tree[key] == expected.contains(key));
+    REQUIRE(tree.tree[key] == expected.contains(key));
+  }
+}
+
+TEST_CASE("HashIndexed Lookups while the index grows") {
+  constexpr int NUM_ITER = 10, NUM_ELEMS = 1 << 14, NUM_READERS = 2;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    HashIndexedBST<int> tree{1};
+    // Odd keys stay present the whole time, even keys get added
+    for (int k = 1; k < NUM_ELEMS; k += 2)
+      tree.insert(k);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < NUM_READERS; r++) {
+      readers.emplace_back([&tree, &done, &misses]() {
+        while (!done.load()) {
+          for (int k = 1; k < NUM_ELEMS; k += 2)
+            misses += !tree[k];
+          std::this_thread::yield();
+        }
+      });
+    }
+
+    for (int k = 0; k < NUM_ELEMS; k += 2)
+      REQUIRE(tree.insert(k));
+    done.store(true);
+    for (std::thread& reader : readers)
+      reader.join();
+
+    REQUIRE(misses.load() == 0);
+
+    for (int k = 0; k < NUM_ELEMS; k++)
+      REQUIRE(tree[k]);
+  }
+}
+
+TEST_CASE("HashIndexed Linearizability Sanity Check") {
+  constexpr int NUM_ITER = 10000, NUM_INSERTION = 100;
+  std::vector<bool> arr;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    HashIndexedBST<int> tree{1};
+    std::counting_semaphore<2> sem{0};
+
+    std::thread t1{[&]() {
+      sem.acquire();
+      for (int i = 0; i < NUM_INSERTION; i++)
+        tree.insert(i);
+    }};
+
+    std::thread t2{[&]() {
+      sem.acquire();
+      for (int i = 0; i < NUM_INSERTION; i++)
+        arr.emplace_back(!tree.remove(i));
+    }};
+
+    sem.release(2);
+    t1.join();
+    t2.join();
+
+    for (int i = 0; i < NUM_INSERTION; i++) {
+      REQUIRE(tree[i] == arr[i]);
+    }
+    arr.clear();
+  }
+}
+
+TEST_CASE("HashIndexed Insertion - Insertion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 10, NUM_ELEMS_PER_THREAD = 1000;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    HashIndexedBST<int> tree{1};
+
+    const auto insertFunc = [&tree](int start, int end) {
+      for (int k = start; k < end; k++)
+        tree.insert(k);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(insertFunc, thread * NUM_ELEMS_PER_THREAD,
+                           (thread + 1) * NUM_ELEMS_PER_THREAD);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS; thread++)
+      threads[thread].join();
+    for (int num = 0; num < NUM_THREADS * NUM_ELEMS_PER_THREAD; num++)
+      REQUIRE(tree[num]);
+  }
+}
+
+TEST_CASE("HashIndexed Deletion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 50, NUM_ELEMS_PER_THREAD = 400,
+                MOD = 64;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    HashIndexedBST<int> tree{1};
+    // Balanced tree insertion
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          tree.insert(mid);
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, MOD * NUM_ELEMS_PER_THREAD - 1);
+
+    const auto deleteFunc = [&tree](int start) {
+      for (int k = 0; k < NUM_ELEMS_PER_THREAD; k++) {
+        int cur = start + MOD * k;
+        tree.remove(cur);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(deleteFunc, thread);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS; thread++)
+      threads[thread].join();
+
+    for (int num = 0; num < NUM_THREADS * NUM_ELEMS_PER_THREAD; num++) {
+      if (num % MOD < NUM_THREADS)
+        REQUIRE(!tree[num]);
+      else
+        REQUIRE(tree[num]);
+    }
+  }
+}
+
+TEST_CASE("HashIndexed Insertion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 64, OFFSET = 16384;
+  constexpr int DELETIONS_PER_THREAD = OFFSET / NUM_THREADS;
+  constexpr int INSERTIONS_PER_THREAD = 500;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    HashIndexedBST<int> tree{1};
+    // Balanced tree insertion
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          tree.insert(mid);
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, OFFSET - 1);
+
+    const auto deleteFunc = [&tree, &DELETIONS_PER_THREAD](int start) {
+      for (int k = start * DELETIONS_PER_THREAD,
+               e = (start + 1) * DELETIONS_PER_THREAD;
+           k < e; k++) {
+        tree.remove(k);
+      }
+    };
+
+    const auto insertionFunc = [&tree, &OFFSET,
+                                &INSERTIONS_PER_THREAD](int start) {
+      for (int k = 0; k < INSERTIONS_PER_THREAD; k++) {
+        tree.insert(OFFSET + start * INSERTIONS_PER_THREAD + k);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS * 2);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(deleteFunc, thread);
+      threads.emplace_back(insertionFunc, thread);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS * 2; thread++)
+      threads[thread].join();
+
+    for (int num = 0; num < OFFSET; num++)
+      REQUIRE(!tree[num]);
+    for (int num = OFFSET; num < OFFSET + INSERTIONS_PER_THREAD * NUM_THREADS;
+         num++)
+      REQUIRE(tree[num]);
+  }
+}
+
+TEST_CASE("HashIndexed Memory stats") {
+  constexpr int NUM = 1000;
+  HashIndexedBST<int> tree{1};
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  const MemoryStats stats = tree.memory_stats(),
+                    treeStats = tree.tree.memory_stats();
+  REQUIRE(stats.keys == NUM / 2);
+  REQUIRE(treeStats.keys == NUM / 2);
+  REQUIRE(stats.liveBytes > treeStats.liveBytes);
+  REQUIRE(stats.retiredNodes > treeStats.retiredNodes);
+}
+TEST_CASE("HashIndexed Removed entries are freed") {
+  constexpr int ROUNDS = 100000, BOUND = 1000;
+  HashIndexedBST<int> tree{1};
+  for (int i = 0; i < ROUNDS; i++) {
+    REQUIRE(tree.insert(i));
+    REQUIRE(tree.remove(i));
+  }
+  // The tree keeps its unlinked nodes, the index frees its entries and tables
+  const std::size_t retired = tree.memory_stats().retiredNodes -
+                              tree.tree.memory_stats().retiredNodes;
+  REQUIRE(retired < BOUND);
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Records histories of set operations run by many threads and checks them
+// for linearizability. A set is P-compositional, a history is linearizable
+// iff its restriction to every key is, so each key is checked on its own
+// with the Wing & Gong search, memoised as in Lowe's variant.
+namespace Linearizability {
+enum class OpType { CONTAINS, INSERT, REMOVE };
+
+struct Op {
+  OpType type;
+  int key;
+  bool result = false;
+  // Ticks of a shared counter, an op precedes another iff its response is
+  // before the other's invoke
+  uint64_t invoke = 0, response = 0;
+};
+
+using History = std::vector<Op>;
+
+// Hands out strictly increasing timestamps to every thread
+struct Clock {
+  std::atomic<uint64_t> ticks{0};
+
+  uint64_t now() { return ticks.fetch_add(1, std::memory_order_seq_cst); }
+};
+
+template <class Set>
+bool apply(Set& set, OpType type, int key) {
+  switch (type) {
+    case OpType::CONTAINS:
+      return set[key];
+    case OpType::INSERT:
+      return set.insert(key);
+    case OpType::REMOVE:
+      return set.remove(key);
+  }
+  return false;
+}
+
+// Runs opsPerThread random operations on keys [0, keys) from each of threads
+// threads and returns the merged history
+template <class Set>
+History record(Set& set, int threads, int opsPerThread, int keys,
+               unsigned seed) {
+  Clock clock;
+  std::vector<History> histories(threads);
+  std::vector<std::thread> workers;
+  for (int tid = 0; tid < threads; tid++) {
+    workers.emplace_back([&, tid] {
+      std::mt19937 rng{seed + tid};
+      std::uniform_int_distribution<int> key{0, keys - 1}, type{0, 2};
+      History& history = histories[tid];
+      history.reserve(opsPerThread);
+      for (int i = 0; i < opsPerThread; i++) {
+        Op op{static_cast<OpType>(type(rng)), key(rng)};
+        op.invoke = clock.now();
+        op.result = apply(set, op.type, op.key);
+        op.response = clock.now();
+        history.push_back(op);
+      }
+    });
+  }
+  for (std::thread& worker : workers)
+    worker.join();
+
+  History merged;
+  for (const History& history : histories)
+    merged.insert(merged.end(), history.begin(), history.end());
+  return merged;
+}
+
+// Result the op has on a key that is present or not, and the state it leaves
+inline bool step(OpType type, bool& present) {
+  switch (type) {
+    case OpType::CONTAINS:
+      return present;
+    case OpType::INSERT:
+      return !std::exchange(present, true);
+    case OpType::REMOVE:
+      return std::exchange(present, false);
+  }
+  return false;
+}
+
+// Wing & Gong on the ops of a single key, which starts out absent
+inline bool checkKey(const History& ops) {
+  const int n = ops.size();
+  // Doubly linked list of invoke and response events in time order, event
+  // 2i is the invoke of op i and 2i + 1 its response. Node 0 is the head.
+  struct Event {
+    uint64_t time;
+    int id;
+  };
+  std::vector<Event> events;
+  events.reserve(2 * n);
+  for (int i = 0; i < n; i++) {
+    events.push_back({ops[i].invoke, 2 * i});
+    events.push_back({ops[i].response, 2 * i + 1});
+  }
+  std::sort(events.begin(), events.end(),
+            [](const Event& a, const Event& b) { return a.time < b.time; });
+
+  std::vector<int> next(2 * n + 1), prev(2 * n + 1);
+  int last = 0;
+  for (const Event& event : events) {
+    next[last] = event.id + 1;
+    prev[event.id + 1] = last;
+    last = event.id + 1;
+  }
+  next[last] = -1;
+  auto lift = [&](int op) {
+    for (const int node : {2 * op + 1, 2 * op + 2}) {
+      next[prev[node]] = next[node];
+      if (next[node] != -1)
+        prev[next[node]] = prev[node];
+    }
+  };
+  auto unlift = [&](int op) {
+    for (const int node : {2 * op + 2, 2 * op + 1}) {
+      next[prev[node]] = node;
+      if (next[node] != -1)
+        prev[next[node]] = node;
+    }
+  };
+
+  // Linearised ops and the state they lead to, seen before
+  struct Config {
+    std::vector<uint64_t> linearized;
+    bool present;
+    bool operator==(const Config&) const = default;
+  };
+  struct ConfigHash {
+    std::size_t operator()(const Config& config) const {
+      std::size_t hash = config.present;
+      for (const uint64_t word : config.linearized)
+        hash = hash * 0x9e3779b97f4a7c15ULL + word;
+      return hash;
+    }
+  };
+  std::unordered_set<Config, ConfigHash> seen;
+
+  struct Choice {
+    int op;
+    bool present;
+  };
+  std::vector<Choice> stack;
+  std::vector<uint64_t> linearized((n + 63) / 64);
+  bool present = false;
+  int node = next[0];
+  while (next[0] != -1) {
+    if (node == -1)
+      return false;
+    const int id = node - 1, op = id / 2;
+    if (id % 2 == 0) {
+      bool after = present;
+      if (step(ops[op].type, after) == ops[op].result) {
+        linearized[op / 64] |= uint64_t{1} << (op % 64);
+        if (seen.insert({linearized, after}).second) {
+          stack.push_back({op, present});
+          present = after;
+          lift(op);
+          node = next[0];
+          continue;
+        }
+        linearized[op / 64] &= ~(uint64_t{1} << (op % 64));
+      }
+      node = next[node];
+      continue;
+    }
+
+    // An op responded before any order of the pending ones worked out
+    if (stack.empty())
+      return false;
+    const Choice choice = stack.back();
+    stack.pop_back();
+    present = choice.present;
+    linearized[choice.op / 64] &= ~(uint64_t{1} << (choice.op % 64));
+    unlift(choice.op);
+    node = next[2 * choice.op + 1];
+  }
+  return true;
+}
+
+// Keys whose ops cannot be linearised, empty if the history is linearizable
+inline std::vector<int> check(const History& history) {
+  std::map<int, History> byKey;
+  for (const Op& op : history)
+    byKey[op.key].push_back(op);
+
+  std::vector<int> failed;
+  for (const auto& [key, ops] : byKey) {
+    if (!checkKey(ops))
+      failed.push_back(key);
+  }
+  return failed;
+}
+
+inline std::string describe(const Op& op) {
+  static const char* const NAMES[] = {"contains", "insert", "remove"};
+  return std::string{NAMES[static_cast<int>(op.type)]} + "(" +
+         std::to_string(op.key) + ") -> " + (op.result ? "true" : "false") +
+         " [" + std::to_string(op.invoke) + ", " +
+         std::to_string(op.response) + "]";
+}
+}  // namespace Linearizability
@@ -0,0 +1,96 @@
+#include <thread>
+#include <vector>
+
+#include "Linearizability.h"
+#include "catch.hpp"
+#include "src/AdaptiveRadixTree/AdaptiveRadixTree.h"
+#include "src/BLinkTree/BLinkTree.h"
+#include "src/CATree/CATree.h"
+#include "src/CGLBBST/CGLBBST.h"
+#include "src/CoarseGrainedLockingBST/CGLBST.h"
+#include "src/FilteredBST/FilteredBST.h"
+#include "src/FineGrainedLockingBST/FGLBST.h"
+#include "src/FlatCombiningBST/FlatCombiningBST.h"
+#include "src/HashIndexedBST/HashIndexedBST.h"
+#include "src/NatarajanBST/NatarajanBST.h"
+#include "src/SinghBBST/SinghBBST.h"
+#include "src/SnapshotBST/SnapshotBST.h"
+#include "src/SortedArraySet/SortedArraySet.h"
+
+using Linearizability::History;
+using Linearizability::OpType;
+
+TEST_CASE("Linearizability checker") {
+  SECTION("Sequential history") {
+    const History history{{OpType::INSERT, 1, true, 0, 1},
+                          {OpType::CONTAINS, 1, true, 2, 3},
+                          {OpType::INSERT, 1, false, 4, 5},
+                          {OpType::REMOVE, 1, true, 6, 7},
+                          {OpType::CONTAINS, 1, false, 8, 9}};
+    REQUIRE(Linearizability::check(history).empty());
+  }
+
+  SECTION("Lookup misses an insert that returned before it started") {
+    const History history{{OpType::INSERT, 1, true, 0, 1},
+                          {OpType::CONTAINS, 1, false, 2, 3}};
+    REQUIRE(Linearizability::check(history) == std::vector<int>{1});
+  }
+
+  SECTION("Overlapping ops may take effect in either order") {
+    // The lookup overlaps both the insert and the removal
+    const History history{{OpType::INSERT, 1, true, 0, 2},
+                          {OpType::CONTAINS, 1, false, 1, 6},
+                          {OpType::REMOVE, 1, true, 3, 4}};
+    REQUIRE(Linearizability::check(history).empty());
+  }
+
+  SECTION("Two inserts of a key cannot both succeed") {
+    const History history{{OpType::INSERT, 1, true, 0, 3},
+                          {OpType::INSERT, 1, true, 1, 2},
+                          {OpType::INSERT, 2, true, 4, 5}};
+    REQUIRE(Linearizability::check(history) == std::vector<int>{1});
+  }
+
+  SECTION("Backtracks out of a wrong first choice") {
+    // The insert is tried first, but the miss has to come before it
+    const History history{{OpType::INSERT, 1, true, 0, 10},
+                          {OpType::CONTAINS, 1, false, 1, 11},
+                          {OpType::CONTAINS, 1, true, 12, 13}};
+    REQUIRE(Linearizability::check(history).empty());
+  }
+}
+
+// Searches start from a routing index over the top levels
+template <class Tree>
+struct Routed : Tree {
+  Routed() { this->set_routing_levels(4); }
+};
+
+TEMPLATE_TEST_CASE("Linearizability of random histories", "", NatarajanBST<int>,
+                   SinghBBST<int>, CGLBST<int>, FGLBST<int>, CGLBBST<int>,
+                   AdaptiveRadixTree<int>, BLinkTree<int>, SnapshotBST<int>,
+                   HashIndexedBST<int>, FilteredBST<int>, CATree<int>,
+                   (CGLBST<int, BigReaderLock>),
+                   (CGLBBST<int, BigReaderLock>), FlatCombiningBST<int>,
+                   (FlatCombiningBST<int, CGLBBST<int>>),
+                   SortedArraySet<int>, Routed<NatarajanBST<int>>,
+                   Routed<SinghBBST<int>>) {
+  constexpr int NUM_THREADS = 4;
+  constexpr int OPS_PER_THREAD = 20000;
+  // Few keys so that ops on a key overlap often
+  constexpr int KEYS = 16;
+
+  for (unsigned seed = 0; seed < 5; seed++) {
+    TestType tree;
+    const History history =
+        Linearizability::record(tree, NUM_THREADS, OPS_PER_THREAD, KEYS, seed);
+    const std::vector<int> failed = Linearizability::check(history);
+    for (const int key : failed) {
+      for (const Linearizability::Op& op : history) {
+        if (op.key == key)
+          UNSCOPED_INFO(Linearizability::describe(op));
+      }
+    }
+    REQUIRE(failed.empty());
+  }
+}
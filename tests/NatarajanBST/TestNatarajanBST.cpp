@@ -1,9 +1,15 @@
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <random>
 #include <semaphore>
+#include <set>
 #include <thread>
 #include <vector>
 
 #include "catch.hpp"
 #include "src/NatarajanBST/NatarajanBST.h"
+#include "tests/utils.h"
 
 TEST_CASE("Natarajan Insertion sequential check") {
   NatarajanBST<int> tree;
@@ -211,4 +217,185 @@ TEST_CASE("Natarajan Insertion - Deletion Race") {
          num++)
       REQUIRE(tree[num]);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Natarajan Memory stats") {
+  constexpr int NUM = 1000;
+  NatarajanBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+
+  MemoryStats stats = tree.memory_stats();
+  REQUIRE(stats.keys == NUM);
+  // Every key is an internal node plus a leaf, on top of five sentinels
+  REQUIRE(stats.liveNodes == 2 * NUM + 5);
+  REQUIRE(stats.retiredNodes == 0);
+
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+  stats = tree.memory_stats();
+  REQUIRE(stats.keys == NUM / 2);
+  REQUIRE(stats.liveNodes == NUM + 5);
+  REQUIRE(stats.retiredNodes == NUM);
+  REQUIRE(stats.totalBytes() == (2 * NUM + 5) * sizeof(Node<int>));
+}
+TEST_CASE("Natarajan Height") {
+  constexpr int NUM = 1000;
+  NatarajanBST<int> tree;
+  // Root, S and the inf0 leaf
+  REQUIRE(tree.height() == 3);
+  // Ascending keys chain up under the inf0 internal node
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  REQUIRE(tree.height() == NUM + 3);
+}
+TEST_CASE("Natarajan Shape stats") {
+  constexpr int NUM = 1000;
+  NatarajanBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  const ShapeStats shape = tree.shape_stats();
+  REQUIRE(shape.keys == NUM / 2);
+  REQUIRE(shape.nodes == NUM + 5);
+  // Every key is a leaf, as are the three sentinel leaves
+  REQUIRE(shape.leaves() == NUM / 2 + 3);
+  REQUIRE(shape.deletedNodes == 0);
+  // Sorted inserts leave a list, the sentinel leaf of the root sits at depth 2
+  REQUIRE(shape.height == NUM / 2 + 3);
+  REQUIRE(shape.maxImbalance == NUM / 2 + 1);
+  REQUIRE(shape.averagePathLength() > NUM / 4);
+}
+
+TEST_CASE("Natarajan Op counters") {
+  constexpr int NUM = 100;
+  NatarajanBST<int> tree;
+  OpCounters::reset();
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  const OpCounters::Totals totals = OpCounters::collect();
+  if (!OpCounters::ENABLED) {
+    REQUIRE(totals == OpCounters::Totals{});
+    return;
+  }
+  // Alone in the tree nothing is retried or helped
+  REQUIRE(totals[OpCounters::SEEK] == NUM + NUM / 2);
+  REQUIRE(totals[OpCounters::CLEANUP] == NUM / 2);
+  // One insertion CAS per key, a flag and an unlink CAS per removal
+  REQUIRE(totals[OpCounters::CAS] == NUM + NUM);
+  REQUIRE(totals[OpCounters::CAS_FAILED] == 0);
+  REQUIRE(totals[OpCounters::RETRY] == 0);
+  // Sequential keys build a chain
+  REQUIRE(totals[OpCounters::SEEK_DEPTH] >= NUM * (NUM - 1) / 2);
+}
+
+TEST_CASE("Natarajan Routing index") {
+  constexpr int NUM_OPS = 200000, KEY_RANGE = 2000, LEVELS = 6;
+  NatarajanBST<int> tree;
+  tree.set_routing_levels(LEVELS);
+  const std::size_t emptyIndexBytes = tree.memory_stats().descriptorBytes;
+  std::set<int> expected;
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> keyDist{0, KEY_RANGE - 1}, opDist{0, 2};
+
+  for (int i = 0; i < NUM_OPS; i++) {
+    int key = keyDist(gen);
+    switch (opDist(gen)) {
+      case 0:
+        REQUIRE(tree.insert(key) == expected.insert(key).second);
+        break;
+      case 1:
+        REQUIRE(tree.remove(key) == (expected.erase(key) == 1));
+        break;
+      default:
+        REQUIRE(tree[key] == (expected.count(key) == 1));
+    }
+  }
+  // The index built over the empty tree was too shallow and got rebuilt
+  REQUIRE(tree.memory_stats().descriptorBytes > emptyIndexBytes);
+
+  tree.set_routing_levels(0);
+  for (int key = 0; key < KEY_RANGE; key++)
+    REQUIRE(tree[key] == (expected.count(key) == 1));
+}
+
+TEST_CASE("Natarajan Routed Insertion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 16, KEYS = 4096, ROUNDS = 20;
+  // Close to the leaves, so that entries go stale and are rebuilt often
+  constexpr int LEVELS = 10;
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    NatarajanBST<int> tree;
+    insertEvenKeys(tree, KEYS);
+    tree.set_routing_levels(LEVELS);
+    checkOddKeyRace(tree, NUM_THREADS, KEYS, ROUNDS);
+  }
+}
+
+TEST_CASE("Natarajan Pop min and max") {
+  constexpr int NUM = 2000, KEY_RANGE = 100000, SPRAY = 3;
+  NatarajanBST<int> tree;
+  std::set<int> expected;
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> keyDist{0, KEY_RANGE - 1};
+
+  REQUIRE(!tree.try_pop_min());
+  REQUIRE(!tree.try_pop_max());
+  for (int i = 0; i < NUM; i++) {
+    int key = keyDist(gen);
+    REQUIRE(tree.insert(key) == expected.insert(key).second);
+  }
+  // Pops alternate between both ends, then take keys near them at random
+  while (expected.size() > NUM / 2) {
+    REQUIRE(tree.try_pop_min() == *expected.begin());
+    expected.erase(expected.begin());
+    REQUIRE(tree.try_pop_max() == *expected.rbegin());
+    expected.erase(std::prev(expected.end()));
+  }
+  for (int i = 0; !expected.empty(); i++) {
+    const std::optional<int> key =
+        i % 2 == 0 ? tree.try_pop_min(SPRAY) : tree.try_pop_max(SPRAY);
+    REQUIRE(key);
+    REQUIRE(expected.erase(*key) == 1);
+    REQUIRE(!tree[*key]);
+  }
+  REQUIRE(!tree.try_pop_min(SPRAY));
+  REQUIRE(!tree.try_pop_max(SPRAY));
+}
+
+TEST_CASE("Natarajan Concurrent pops take every key once") {
+  constexpr int NUM_ITER = 5, NUM_THREADS = 8, KEYS = 20000, SPRAY = 4;
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    NatarajanBST<int> tree;
+    for (int i = 0; i < KEYS; i++)
+      tree.insert(i);
+
+    // Threads take keys from both ends, with and without spraying
+    std::vector<std::vector<int>> popped(NUM_THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+      threads.emplace_back([&tree, &popped, t] {
+        const int spray = t / 2 % 2 == 0 ? 0 : SPRAY;
+        while (const std::optional<int> key = t % 2 == 0
+                                                  ? tree.try_pop_min(spray)
+                                                  : tree.try_pop_max(spray))
+          popped[t].push_back(*key);
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+
+    std::vector<int> seen(KEYS);
+    for (const std::vector<int>& keys : popped) {
+      for (const int key : keys)
+        seen[key]++;
+    }
+    REQUIRE(std::count(seen.begin(), seen.end(), 1) == KEYS);
+  }
+}
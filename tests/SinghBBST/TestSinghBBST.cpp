@@ -1,4 +1,11 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <optional>
+#include <random>
 #include <semaphore>
+#include <set>
 #include <thread>
 #include <vector>
 
@@ -12,6 +19,7 @@ DEFINE_ACCESSOR(SinghBBST<int>, maintainenceThread)
 
 DEFINE_CALLER(SinghBBST<int>, helpRotate)
 DEFINE_CALLER(SinghBBST<int>, maintainHelper)
+DEFINE_CALLER(SinghBBST<int>, coverPopBounds)
 
 TEST_CASE("Singh BBST Sanity Check") {
   SinghBBST<int> tree;
@@ -472,3 +480,335 @@ TEST_CASE("Double rotation test") {
     REQUIRE(node3->key == 3);
   }
 }
+
+TEST_CASE("Singh Memory stats") {
+  constexpr int NUM = 1000;
+  SinghBBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  // The balancing thread may be halfway through a rotation during the walk
+  MemoryStats stats = tree.memory_stats();
+  for (int attempt = 0; attempt < 100 && stats.keys != NUM / 2; attempt++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stats = tree.memory_stats();
+  }
+  REQUIRE(stats.keys == NUM / 2);
+  // Removal only marks nodes and every update leaves an operation record
+  REQUIRE(stats.liveNodes >= NUM);
+  REQUIRE(stats.descriptorBytes >= NUM * sizeof(Operation<int>));
+}
+
+TEST_CASE("Singh Height") {
+  constexpr int NUM = 1000;
+  SinghBBST<int> tree;
+  REQUIRE(tree.height() == 0);
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+
+  // Ascending keys start out as a list that the balancing thread rotates
+  int height = tree.height();
+  for (int attempt = 0; attempt < 100 && height > 20; attempt++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    height = tree.height();
+  }
+  REQUIRE(height <= 20);
+  REQUIRE(height >= 10);
+}
+
+TEST_CASE("Singh Shape stats") {
+  constexpr int NUM = 1000;
+  SinghBBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  // The balancing thread may be halfway through a rotation during the walk
+  ShapeStats shape = tree.shape_stats();
+  for (int attempt = 0; attempt < 100 && shape.keys != NUM / 2; attempt++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    shape = tree.shape_stats();
+  }
+  REQUIRE(shape.keys == NUM / 2);
+  // Removal only marks a node, the balancing thread unlinks some of them
+  REQUIRE(shape.deletedNodes <= NUM / 2);
+  REQUIRE(shape.nodes == shape.keys + shape.deletedNodes);
+  REQUIRE(shape.leaves() > 0);
+  REQUIRE(shape.height >= 10);
+}
+
+TEST_CASE("Singh Op counters") {
+  constexpr int NUM = 100;
+  SinghBBST<int> tree;
+  OpCounters::reset();
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  const OpCounters::Totals totals = OpCounters::collect();
+  if (!OpCounters::ENABLED) {
+    REQUIRE(totals == OpCounters::Totals{});
+    return;
+  }
+  // The balancing thread may make an operation seek again
+  REQUIRE(totals[OpCounters::SEEK] >= NUM + NUM / 2);
+  REQUIRE(totals[OpCounters::SEEK_DEPTH] > 0);
+  // An operation flag per insertion, a deleted mark per removal
+  REQUIRE(totals[OpCounters::CAS] - totals[OpCounters::CAS_FAILED] >=
+          NUM + NUM / 2);
+  // Nothing is routed without an index
+  REQUIRE(totals[OpCounters::ROUTED] == 0);
+  REQUIRE(totals[OpCounters::ROUTE_STALE] == 0);
+}
+
+TEST_CASE("Singh Routing index") {
+  constexpr int NUM_OPS = 200000, KEY_RANGE = 2000, LEVELS = 6;
+  SinghBBST<int> tree;
+  tree.set_routing_levels(LEVELS);
+  const std::size_t emptyIndexBytes = tree.memory_stats().descriptorBytes;
+  std::set<int> expected;
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> keyDist{0, KEY_RANGE - 1}, opDist{0, 2};
+
+  for (int i = 0; i < NUM_OPS; i++) {
+    int key = keyDist(gen);
+    switch (opDist(gen)) {
+      case 0:
+        REQUIRE(tree.insert(key) == expected.insert(key).second);
+        break;
+      case 1:
+        REQUIRE(tree.remove(key) == (expected.erase(key) == 1));
+        break;
+      default:
+        REQUIRE(tree[key] == (expected.count(key) == 1));
+    }
+  }
+  // The index built over the empty tree was too shallow and got rebuilt
+  REQUIRE(tree.memory_stats().descriptorBytes > emptyIndexBytes);
+
+  tree.set_routing_levels(0);
+  for (int key = 0; key < KEY_RANGE; key++)
+    REQUIRE(tree[key] == (expected.count(key) == 1));
+}
+
+TEST_CASE("Singh Routed Insertion - Deletion Race") {
+  constexpr int NUM_ITER = 5, NUM_THREADS = 16, KEYS = 4096, ROUNDS = 20;
+  // Close to the leaves, so that entries go stale and are rebuilt often
+  constexpr int LEVELS = 10;
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    SinghBBST<int> tree;
+    insertEvenKeys(tree, KEYS);
+    tree.set_routing_levels(LEVELS);
+    checkOddKeyRace(tree, NUM_THREADS, KEYS, ROUNDS);
+  }
+}
+
+TEST_CASE("Singh Pop min and max") {
+  constexpr int NUM = 2000, KEY_RANGE = 100000, SPRAY = 3;
+  SinghBBST<int> tree;
+  std::set<int> expected;
+  std::mt19937 gen{42};
+  std::uniform_int_distribution<int> keyDist{0, KEY_RANGE - 1};
+
+  REQUIRE(!tree.try_pop_min());
+  REQUIRE(!tree.try_pop_max());
+  for (int i = 0; i < NUM; i++) {
+    int key = keyDist(gen);
+    REQUIRE(tree.insert(key) == expected.insert(key).second);
+  }
+  // Pops alternate between both ends, then take keys near them at random
+  while (expected.size() > NUM / 2) {
+    REQUIRE(tree.try_pop_min() == *expected.begin());
+    expected.erase(expected.begin());
+    REQUIRE(tree.try_pop_max() == *expected.rbegin());
+    expected.erase(std::prev(expected.end()));
+  }
+  // Keys inserted beyond the ones popped so far are popped next
+  REQUIRE(tree.insert(-1));
+  REQUIRE(tree.insert(KEY_RANGE));
+  REQUIRE(tree.try_pop_min() == -1);
+  REQUIRE(tree.try_pop_max() == KEY_RANGE);
+  for (int i = 0; !expected.empty(); i++) {
+    const std::optional<int> key =
+        i % 2 == 0 ? tree.try_pop_min(SPRAY) : tree.try_pop_max(SPRAY);
+    REQUIRE(key);
+    REQUIRE(expected.erase(*key) == 1);
+    REQUIRE(!tree[*key]);
+  }
+  REQUIRE(!tree.try_pop_min(SPRAY));
+  REQUIRE(!tree.try_pop_max(SPRAY));
+}
+
+TEST_CASE("Singh Concurrent pops take every key once") {
+  constexpr int NUM_ITER = 5, NUM_THREADS = 8, KEYS = 20000, SPRAY = 4;
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    SinghBBST<int> tree;
+    for (int i = 0; i < KEYS; i++)
+      tree.insert(i);
+
+    // Threads pop from both ends, with and without spraying
+    std::vector<std::vector<int>> popped(NUM_THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+      threads.emplace_back([&tree, &popped, t] {
+        const int spray = t / 2 % 2 == 0 ? 0 : SPRAY;
+        while (const std::optional<int> key = t % 2 == 0
+                                                  ? tree.try_pop_min(spray)
+                                                  : tree.try_pop_max(spray))
+          popped[t].push_back(*key);
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+
+    std::vector<int> seen(KEYS);
+    for (const std::vector<int>& keys : popped) {
+      for (const int key : keys)
+        seen[key]++;
+    }
+    REQUIRE(std::count(seen.begin(), seen.end(), 1) == KEYS);
+  }
+}
+
+TEST_CASE("Singh Pops next to inserts lose no key") {
+  constexpr int NUM_ITER = 5, NUM_THREADS = 4, KEYS = 20000, SPRAY = 4;
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    SinghBBST<int> tree;
+    for (int i = 0; i < KEYS; i += 2)
+      tree.insert(i);
+
+    // Odd keys go in ascending, right where the pops from below are
+    std::vector<std::vector<int>> popped(NUM_THREADS + 1);
+    std::atomic<int> inserting{NUM_THREADS}, failed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; t++) {
+      threads.emplace_back([&tree, &inserting, &failed, t] {
+        std::vector<int> keys;
+        for (int i = 1 + 2 * t; i < KEYS; i += 2 * NUM_THREADS)
+          keys.push_back(i);
+        for (const int key : keys)
+          failed += !tree.insert(key);
+        inserting--;
+      });
+      threads.emplace_back([&tree, &popped, &inserting, t] {
+        const int spray = t % 2 == 0 ? 0 : SPRAY;
+        while (inserting > 0) {
+          const std::optional<int> key =
+              t / 2 % 2 == 0 ? tree.try_pop_min(spray)
+                             : tree.try_pop_max(spray);
+          if (key)
+            popped[t].push_back(*key);
+        }
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+    while (const std::optional<int> key = tree.try_pop_min())
+      popped[NUM_THREADS].push_back(*key);
+
+    REQUIRE(failed == 0);
+    std::vector<int> seen(KEYS);
+    for (const std::vector<int>& keys : popped) {
+      for (const int key : keys)
+        seen[key]++;
+    }
+    REQUIRE(std::count(seen.begin(), seen.end(), 1) == KEYS);
+    for (int i = 0; i < KEYS; i++)
+      REQUIRE(!tree[i]);
+  }
+}
+
+TEST_CASE("Singh Pops reach a key linked behind their bound") {
+  SinghBBST<int> tree;
+  PrivateAccess::get_finished(tree).store(true);
+  PrivateAccess::get_maintainenceThread(tree).join();
+  for (const int key : {10, 20, 30})
+    tree.insert(key);
+  REQUIRE(tree.try_pop_min() == 10);
+
+  // An insert of 5 that linked its key, where the insert would below the
+  // smallest key, but has not moved the bounds yet
+  Singh::Node<int>* node = PrivateAccess::get_root(tree);
+  while (node->left.load() != nullptr)
+    node = node->left.load();
+  node->left.store(new Singh::Node<int>(5));
+  REQUIRE(tree.try_pop_min() == 20);
+
+  PrivateAccess::call_coverPopBounds(tree, 5);
+  REQUIRE(tree.try_pop_min() == 5);
+  REQUIRE(tree.try_pop_min() == 30);
+  REQUIRE(!tree.try_pop_min());
+}
+
+TEST_CASE("Singh Pops take a key no larger than one inserted before") {
+  constexpr int NUM_ITER = 5, KEYS = 20000;
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    for (const bool max : {false, true}) {
+      SinghBBST<int> tree;
+      // Every insert brings the key the next pop should take
+      const auto keyAt = [max](int i) { return max ? i : KEYS - 1 - i; };
+      std::atomic<int> inserted{0}, failed{0};
+      std::thread inserter{[&tree, &inserted, &keyAt] {
+        for (int i = 0; i < KEYS; i++) {
+          tree.insert(keyAt(i));
+          inserted = i + 1;
+        }
+      }};
+
+      std::vector<bool> popped(KEYS);
+      while (inserted < KEYS) {
+        const int i = inserted - 1;
+        const std::optional<int> key =
+            max ? tree.try_pop_max() : tree.try_pop_min();
+        if (!key)
+          continue;
+        popped[*key] = true;
+        // The key of an insert that returned is still there unless this
+        // thread popped it
+        if (i >= 0 && !popped[keyAt(i)])
+          failed += max ? *key < keyAt(i) : *key > keyAt(i);
+      }
+      inserter.join();
+      REQUIRE(failed == 0);
+    }
+  }
+}
+
+TEST_CASE("Singh Order statistics") {
+  constexpr int NUM = 1000;
+  SinghBBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  for (int i = 0; i < NUM; i += 2)
+    tree.remove(i);
+
+  // Sizes are exact once the balancing thread passed the settled tree
+  const auto exact = [&tree] {
+    if (tree.size() != NUM / 2)
+      return false;
+    for (int i = 0; i < NUM / 2; i++) {
+      if (tree.rank(2 * i + 1) != static_cast<std::size_t>(i) ||
+          tree.select(i) != 2 * i + 1)
+        return false;
+    }
+    return true;
+  };
+  bool settled = exact();
+  for (int attempt = 0; attempt < 100 && !settled; attempt++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    settled = exact();
+  }
+  REQUIRE(settled);
+  REQUIRE(tree.rank(-1) == 0);
+  REQUIRE(tree.rank(NUM) == NUM / 2);
+  REQUIRE(!tree.select(NUM / 2));
+  REQUIRE(!tree.select(NUM));
+}
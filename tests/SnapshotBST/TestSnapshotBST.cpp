@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <random>
+#include <semaphore>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "src/SnapshotBST/SnapshotBST.h"
+#include "tests/utils.h"
+
+TEST_CASE("Snapshot Insertion sequential check") {
+  SnapshotBST<int> tree;
+  for (int i = 0; i < 100; i++)
+    REQUIRE(!tree[i]);
+  for (int i = 0; i < 100; i++)
+    REQUIRE(tree.insert(i));
+  for (int i = 0; i < 100; i++)
+    REQUIRE(tree[i]);
+}
+
+TEST_CASE("Snapshot Deletion sequential check") {
+  SECTION("0/1 child deletion") {
+    constexpr int NUM = 1000;
+    SnapshotBST<int> tree;
+
+    for (int i = 0; i < NUM; i++)
+      REQUIRE(tree.insert(i));
+    for (int i = 0; i < NUM; i++) {
+      REQUIRE(tree.remove(i));
+      for (int k = 0; k <= i; k++)
+        REQUIRE(!tree[k]);
+      for (int k = i + 1; k < NUM; k++)
+        REQUIRE(tree[k]);
+    }
+  }
+
+  SECTION("2 children deletion") {
+    constexpr int NUM = 1000;
+    SnapshotBST<int> tree;
+
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          REQUIRE(tree.insert(mid));
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, NUM - 1);
+
+    for (int i = 0; i < NUM; i++) {
+      REQUIRE(tree.remove(i));
+      for (int k = 0; k <= i; k++)
+        REQUIRE(!tree[k]);
+      for (int k = i + 1; k < NUM; k++)
+        REQUIRE(tree[k]);
+    }
+  }
+}
+
+TEST_CASE("Snapshot View is unaffected by later updates") {
+  constexpr int NUM = 1000;
+  SnapshotBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(tree.insert(i));
+
+  auto view = tree.snapshot();
+  for (int i = 0; i < NUM; i += 2)
+    REQUIRE(tree.remove(i));
+  for (int i = NUM; i < 2 * NUM; i++)
+    REQUIRE(tree.insert(i));
+
+  for (int i = 0; i < 2 * NUM; i++) {
+    REQUIRE(view[i] == (i < NUM));
+    REQUIRE(tree[i] == (i >= NUM || i % 2 == 1));
+  }
+
+  std::vector<int> seen;
+  view.for_each([&seen](int key) { seen.push_back(key); });
+  REQUIRE(seen.size() == NUM);
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(seen[i] == i);
+
+  auto later = tree.snapshot();
+  seen.clear();
+  later.for_each([&seen](int key) { seen.push_back(key); });
+  REQUIRE(seen.size() == NUM + NUM / 2);
+  REQUIRE(std::is_sorted(seen.begin(), seen.end()));
+}
+
+TEST_CASE("Snapshot Random operations against std::set") {
+  constexpr int NUM_OPS = 100000, KEY_RANGE = 5000, SNAPSHOT_EVERY = 10000;
+  SnapshotBST<int> tree;
+  std::set<int> expected;
+  std::list<std::pair<SnapshotBST<int>::View, std::set<int>>> views;
+  checkRandomOps(tree, expected, NUM_OPS, uniformKeys(KEY_RANGE),
+                 [&tree, &expected, &views](int i, int) {
+                   if (i % SNAPSHOT_EVERY == 0)
+                     views.emplace_back(tree.snapshot(), expected);
+                   // Dropping some views lets their versions be reclaimed
+                   if (i % SNAPSHOT_EVERY == SNAPSHOT_EVERY / 2 &&
+                       views.size() > 2)
+                     views.erase(std::next(views.begin()));
+                 });
+
+  for (const auto& [view, contents] : views) {
+    std::vector<int> seen;
+    view.for_each([&seen](int key) { seen.push_back(key); });
+    REQUIRE(std::equal(seen.begin(), seen.end(), contents.begin(),
+                       contents.end()));
+    for (int key = 0; key < KEY_RANGE; key++)
+      REQUIRE(view[key] == contents.contains(key));
+  }
+}
+
+TEST_CASE("Snapshot Views stay consistent under concurrent writers") {
+  constexpr int NUM_ITER = 10, NUM_KEYS = 20000, NUM_READERS = 2;
+  std::mt19937 gen{42};
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    SnapshotBST<int> tree;
+    // Keys below NUM_KEYS are removed and the others inserted, each in a
+    // fixed order. A consistent view holds a suffix of the removal order and
+    // a prefix of the insertion order.
+    std::vector<int> removeOrder(NUM_KEYS), insertOrder(NUM_KEYS),
+        position(2 * NUM_KEYS);
+    for (int i = 0; i < NUM_KEYS; i++) {
+      removeOrder[i] = i;
+      insertOrder[i] = NUM_KEYS + i;
+    }
+    std::shuffle(removeOrder.begin(), removeOrder.end(), gen);
+    std::shuffle(insertOrder.begin(), insertOrder.end(), gen);
+    for (int i = 0; i < NUM_KEYS; i++) {
+      position[removeOrder[i]] = i;
+      position[insertOrder[i]] = i;
+      tree.insert(removeOrder[i]);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistent{0};
+
+    std::thread inserter{[&]() {
+      for (const int key : insertOrder)
+        tree.insert(key);
+    }};
+    std::thread remover{[&]() {
+      for (const int key : removeOrder)
+        tree.remove(key);
+    }};
+
+    const auto readerFunc = [&]() {
+      while (!done.load()) {
+        auto view = tree.snapshot();
+        int removable = 0, inserted = 0, firstRemovable = NUM_KEYS,
+            lastInserted = -1;
+        view.for_each([&](int key) {
+          if (key < NUM_KEYS) {
+            removable++;
+            firstRemovable = std::min(firstRemovable, position[key]);
+          } else {
+            inserted++;
+            lastInserted = std::max(lastInserted, position[key]);
+          }
+        });
+        if (firstRemovable != NUM_KEYS - removable ||
+            lastInserted != inserted - 1)
+          inconsistent++;
+        std::this_thread::yield();
+      }
+    };
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < NUM_READERS; r++)
+      readers.emplace_back(readerFunc);
+
+    inserter.join();
+    remover.join();
+    done.store(true);
+    for (std::thread& reader : readers)
+      reader.join();
+
+    REQUIRE(inconsistent.load() == 0);
+    for (int i = 0; i < NUM_KEYS; i++) {
+      REQUIRE(!tree[i]);
+      REQUIRE(tree[NUM_KEYS + i]);
+    }
+  }
+}
+
+TEST_CASE("Snapshot Linearizability Sanity Check") {
+  constexpr int NUM_ITER = 10000, NUM_INSERTION = 100;
+  std::vector<bool> arr;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    SnapshotBST<int> tree;
+    std::counting_semaphore<2> sem{0};
+
+    std::thread t1{[&]() {
+      sem.acquire();
+      for (int i = 0; i < NUM_INSERTION; i++)
+        tree.insert(i);
+    }};
+
+    std::thread t2{[&]() {
+      sem.acquire();
+      for (int i = 0; i < NUM_INSERTION; i++)
+        arr.emplace_back(!tree.remove(i));
+    }};
+
+    sem.release(2);
+    t1.join();
+    t2.join();
+
+    for (int i = 0; i < NUM_INSERTION; i++) {
+      REQUIRE(tree[i] == arr[i]);
+    }
+    arr.clear();
+  }
+}
+
+TEST_CASE("Snapshot Insertion - Insertion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 10, NUM_ELEMS_PER_THREAD = 1000;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    SnapshotBST<int> tree;
+
+    const auto insertFunc = [&tree](int start, int end) {
+      for (int k = start; k < end; k++)
+        tree.insert(k);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(insertFunc, thread * NUM_ELEMS_PER_THREAD,
+                           (thread + 1) * NUM_ELEMS_PER_THREAD);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS; thread++)
+      threads[thread].join();
+    for (int num = 0; num < NUM_THREADS * NUM_ELEMS_PER_THREAD; num++)
+      REQUIRE(tree[num]);
+  }
+}
+
+TEST_CASE("Snapshot Deletion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 50, NUM_ELEMS_PER_THREAD = 400,
+                MOD = 64;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    SnapshotBST<int> tree;
+    // Balanced tree insertion
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          tree.insert(mid);
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, MOD * NUM_ELEMS_PER_THREAD - 1);
+
+    const auto deleteFunc = [&tree](int start) {
+      for (int k = 0; k < NUM_ELEMS_PER_THREAD; k++) {
+        int cur = start + MOD * k;
+        tree.remove(cur);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(deleteFunc, thread);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS; thread++)
+      threads[thread].join();
+
+    for (int num = 0; num < NUM_THREADS * NUM_ELEMS_PER_THREAD; num++) {
+      if (num % MOD < NUM_THREADS)
+        REQUIRE(!tree[num]);
+      else
+        REQUIRE(tree[num]);
+    }
+  }
+}
+
+TEST_CASE("Snapshot Insertion - Deletion Race") {
+  constexpr int NUM_ITER = 10, NUM_THREADS = 64, OFFSET = 16384;
+  constexpr int DELETIONS_PER_THREAD = OFFSET / NUM_THREADS;
+  constexpr int INSERTIONS_PER_THREAD = 500;
+
+  for (int i = 0; i < NUM_ITER; i++) {
+    SnapshotBST<int> tree;
+    // Balanced tree insertion
+    const std::function<void(int, int)> balancedInsertFunc =
+        [&tree, &balancedInsertFunc](int start, int end) {
+          if (start > end)
+            return;
+          int mid = start + (end - start) / 2;
+          tree.insert(mid);
+
+          balancedInsertFunc(start, mid - 1);
+          balancedInsertFunc(mid + 1, end);
+        };
+
+    balancedInsertFunc(0, OFFSET - 1);
+
+    const auto deleteFunc = [&tree, &DELETIONS_PER_THREAD](int start) {
+      for (int k = start * DELETIONS_PER_THREAD,
+               e = (start + 1) * DELETIONS_PER_THREAD;
+           k < e; k++) {
+        tree.remove(k);
+      }
+    };
+
+    const auto insertionFunc = [&tree, &OFFSET,
+                                &INSERTIONS_PER_THREAD](int start) {
+      for (int k = 0; k < INSERTIONS_PER_THREAD; k++) {
+        tree.insert(OFFSET + start * INSERTIONS_PER_THREAD + k);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS * 2);
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+      threads.emplace_back(deleteFunc, thread);
+      threads.emplace_back(insertionFunc, thread);
+    }
+
+    for (int thread = 0; thread < NUM_THREADS * 2; thread++)
+      threads[thread].join();
+
+    for (int num = 0; num < OFFSET; num++)
+      REQUIRE(!tree[num]);
+    for (int num = OFFSET; num < OFFSET + INSERTIONS_PER_THREAD * NUM_THREADS;
+         num++)
+      REQUIRE(tree[num]);
+  }
+}
+
+TEST_CASE("Snapshot Memory stats") {
+  constexpr int NUM = 1000;
+  SnapshotBST<int> tree;
+  for (int i = 0; i < NUM; i++)
+    tree.insert(i);
+  const std::size_t versionsBefore = tree.memory_stats().descriptorBytes;
+
+  {
+    auto view = tree.snapshot();
+    for (int i = 0; i < NUM; i += 2)
+      tree.remove(i);
+    const MemoryStats stats = tree.memory_stats();
+    REQUIRE(stats.keys == NUM / 2);
+    // Each removal unlinks a leaf and its parent
+    REQUIRE(stats.liveNodes == NUM + 5);
+    // The view pins the versions it can still read
+    REQUIRE(stats.descriptorBytes > versionsBefore);
+  }
+
+  for (int i = 0; i < NUM; i += 2)
+    tree.insert(i);
+  const MemoryStats stats = tree.memory_stats();
+  REQUIRE(stats.keys == NUM);
+  REQUIRE(stats.liveNodes == 2 * NUM + 5);
+}
+
+TEST_CASE("Snapshot Stats next to updates") {
+  constexpr int NUM_THREADS = 4, KEYS = 2000, ROUNDS = 20;
+  SnapshotBST<int> tree;
+  for (int i = 0; i < KEYS; i += 2)
+    tree.insert(i);
+
+  std::atomic<bool> done{false};
+  std::thread reader{[&tree, &done] {
+    while (!done) {
+      tree.shape_stats();
+      tree.memory_stats();
+    }
+  }};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < NUM_THREADS; t++) {
+    threads.emplace_back([&tree, t] {
+      for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 1 + 2 * t; i < KEYS; i += 2 * NUM_THREADS)
+          tree.insert(i);
+        for (int i = 1 + 2 * t; i < KEYS; i += 2 * NUM_THREADS)
+          tree.remove(i);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  done = true;
+  reader.join();
+
+  REQUIRE(tree.shape_stats().keys == KEYS / 2);
+}
+
+TEST_CASE("Snapshot Unlinked nodes are reclaimed") {
+  constexpr int KEYS = 1000, ROUNDS = 20;
+  SnapshotBST<int> tree;
+
+  SECTION("Without snapshots") {
+    for (int round = 0; round < ROUNDS; round++) {
+      for (int i = 0; i < KEYS; i++)
+        tree.insert(i);
+      for (int i = 0; i < KEYS; i++)
+        tree.remove(i);
+    }
+    REQUIRE(tree.memory_stats().retiredNodes < 2 * KEYS);
+  }
+
+  SECTION("Kept while a snapshot may read them") {
+    for (int i = 0; i < KEYS; i++)
+      tree.insert(i);
+    {
+      auto view = tree.snapshot();
+      for (int i = 0; i < KEYS; i++)
+        tree.remove(i);
+      REQUIRE(tree.memory_stats().retiredNodes >= 2 * KEYS);
+      for (int i = 0; i < KEYS; i++)
+        REQUIRE(view[i]);
+    }
+    for (int round = 0; round < ROUNDS; round++) {
+      for (int i = 0; i < KEYS; i++)
+        tree.insert(i);
+      for (int i = 0; i < KEYS; i++)
+        tree.remove(i);
+    }
+    REQUIRE(tree.memory_stats().retiredNodes < 2 * KEYS);
+  }
+}
@@ -0,0 +1,133 @@
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "src/SortedArraySet/SortedArraySet.h"
+#include "tests/utils.h"
+
+TEST_CASE("SortedArray Insertion sequential check") {
+  constexpr int NUM = 1000;
+  SortedArraySet<int> set;
+
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(!set[i]);
+  for (int i = NUM - 1; i >= 0; i--)
+    REQUIRE(set.insert(i));
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(!set.insert(i));
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(set[i]);
+  REQUIRE(!set[-1]);
+  REQUIRE(!set[NUM]);
+}
+
+TEST_CASE("SortedArray Deletion sequential check") {
+  constexpr int NUM = 1000;
+  SortedArraySet<int> set;
+
+  for (int i = 0; i < NUM; i++)
+    REQUIRE(set.insert(i));
+  for (int i = 0; i < NUM; i++) {
+    REQUIRE(set.remove(i));
+    REQUIRE(!set.remove(i));
+    REQUIRE(!set[i]);
+    if (i + 1 < NUM)
+      REQUIRE(set[i + 1]);
+  }
+}
+
+TEST_CASE("SortedArray Batches are applied as one update") {
+  constexpr int NUM = 1000;
+  SortedArraySet<int> set;
+
+  std::vector<int> keys;
+  for (int i = NUM - 1; i >= 0; i--)
+    keys.push_back(2 * i);
+  // Duplicates within the batch count once
+  keys.push_back(0);
+  REQUIRE(set.insert_all(keys.begin(), keys.end()) == NUM);
+  REQUIRE(set.insert_all(keys.begin(), keys.end()) == 0);
+  // Retiring the empty version was the only update
+  REQUIRE(set.memory_stats().retiredNodes <= 1);
+
+  std::vector<int> odd{1, 2, 3, 4, 5};
+  REQUIRE(set.insert_all(odd.begin(), odd.end()) == 3);
+  REQUIRE(set.remove_all(odd.begin(), odd.end()) == 5);
+  for (int i = 0; i < 2 * NUM; i++)
+    REQUIRE(set[i] == (i % 2 == 0 && i != 2 && i != 4));
+  REQUIRE(set.memory_stats().keys == NUM - 2);
+}
+
+TEST_CASE("SortedArray Random operations against std::set") {
+  constexpr int NUM_OPS = 100000, KEY_RANGE = 2000;
+  SortedArraySet<int> set;
+  std::set<int> expected;
+  checkRandomOps(set, expected, NUM_OPS, uniformKeys(KEY_RANGE));
+  REQUIRE(set.memory_stats().keys == expected.size());
+}
+
+TEST_CASE("SortedArray Old versions are reclaimed") {
+  constexpr int NUM = 10000;
+  SortedArraySet<int> set;
+
+  for (int i = 0; i < NUM; i++) {
+    set.insert(i);
+    REQUIRE(set.memory_stats().retiredNodes <= 3);
+  }
+}
+
+TEST_CASE("SortedArray Lookups race with updates") {
+  constexpr int NUM_ITER = 5, NUM_READERS = 8, KEYS = 4096, ROUNDS = 20,
+                BATCH = 64;
+
+  for (int iter = 0; iter < NUM_ITER; iter++) {
+    SortedArraySet<int> set;
+    // Even keys stay in the set, the writers insert and remove odd ones
+    std::vector<int> even;
+    for (int i = 0; i < KEYS; i += 2)
+      even.push_back(i);
+    set.insert_all(even.begin(), even.end());
+
+    std::atomic<int> failed{0};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < NUM_READERS; t++) {
+      readers.emplace_back([&set, &failed, &done, t] {
+        while (!done) {
+          for (int i = 2 * t; i < KEYS; i += 2 * NUM_READERS)
+            failed += !set[i];
+        }
+      });
+    }
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; t++) {
+      writers.emplace_back([&set, &failed, t] {
+        for (int round = 0; round < ROUNDS; round++) {
+          for (int from = 1 + 2 * BATCH * t; from < KEYS;
+               from += 4 * BATCH) {
+            std::vector<int> batch;
+            for (int i = from; i < from + 2 * BATCH && i < KEYS; i += 2)
+              batch.push_back(i);
+            failed += set.insert_all(batch.begin(), batch.end()) !=
+                      batch.size();
+            failed += !set[batch.back()];
+            failed += set.remove_all(batch.begin(), batch.end()) !=
+                      batch.size();
+          }
+        }
+      });
+    }
+    for (std::thread& thread : writers)
+      thread.join();
+    done = true;
+    for (std::thread& thread : readers)
+      thread.join();
+
+    REQUIRE(failed == 0);
+    for (int i = 0; i < KEYS; i++)
+      REQUIRE(set[i] == (i % 2 == 0));
+    REQUIRE(set.memory_stats().keys == KEYS / 2);
+  }
+}
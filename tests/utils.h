@@ -1,3 +1,14 @@
+#pragma once
+
+#include <atomic>
+#include <latch>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
 namespace PrivateAccess {
 template <auto memberPtr>
 struct CallPrivateFunctions {
@@ -37,4 +48,86 @@ struct AccessPrivateVars {
     }                                                                 \
   };                                                                  \
   auto& get_##class_data_member(qualified_class_name& obj);           \
-  }
\ No newline at end of file
+  }
+
+// Keys drawn uniformly from [0, range)
+inline auto uniformKeys(int range) {
+  return [dist = std::uniform_int_distribution<int>{0, range - 1}](
+             std::mt19937_64& gen, int) mutable { return dist(gen); };
+}
+
+// Runs numOps random inserts, removals and lookups with keys from
+// nextKey(gen, i) on tree and on expected, requiring the same results.
+// beforeOp(i, key) runs ahead of each op.
+template <class Tree, class Key, class NextKey, class BeforeOp>
+void checkRandomOps(Tree& tree, std::set<Key>& expected, int numOps,
+                    NextKey&& nextKey, BeforeOp&& beforeOp) {
+  std::mt19937_64 gen{42};
+  std::uniform_int_distribution<int> opDist{0, 2};
+
+  for (int i = 0; i < numOps; i++) {
+    const Key key = nextKey(gen, i);
+    beforeOp(i, key);
+    switch (opDist(gen)) {
+      case 0:
+        REQUIRE(tree.insert(key) == expected.insert(key).second);
+        break;
+      case 1:
+        REQUIRE(tree.remove(key) == (expected.erase(key) == 1));
+        break;
+      default:
+        REQUIRE(tree[key] == expected.contains(key));
+    }
+  }
+}
+
+template <class Tree, class Key, class NextKey>
+void checkRandomOps(Tree& tree, std::set<Key>& expected, int numOps,
+                    NextKey&& nextKey) {
+  checkRandomOps(tree, expected, numOps, nextKey, [](int, const Key&) {});
+}
+
+// Even keys stay in the tree during checkOddKeyRace
+template <class Tree>
+void insertEvenKeys(Tree& tree, int keys) {
+  for (int i = 0; i < keys; i += 2)
+    tree.insert(i);
+}
+
+// numThreads threads insert and remove their share of the odd keys below
+// keys for rounds rounds, next to the even ones already in tree. Every update
+// has to succeed, and the even key below it has to stay. concurrently(running)
+// runs on this thread meanwhile, running counts the threads not done yet.
+template <class Tree, class Concurrently>
+void checkOddKeyRace(Tree& tree, int numThreads, int keys, int rounds,
+                     Concurrently&& concurrently) {
+  std::latch start{numThreads};
+  std::atomic<int> failed{0}, running{numThreads};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++) {
+    threads.emplace_back([&tree, &start, &failed, &running, numThreads, keys,
+                          rounds, t] {
+      start.arrive_and_wait();
+      for (int round = 0; round < rounds; round++) {
+        for (int i = 1 + 2 * t; i < keys; i += 2 * numThreads)
+          failed += !tree.insert(i) + !tree[i - 1];
+        for (int i = 1 + 2 * t; i < keys; i += 2 * numThreads)
+          failed += !tree.remove(i) + tree[i];
+      }
+      running--;
+    });
+  }
+  concurrently(running);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  REQUIRE(failed == 0);
+  for (int i = 0; i < keys; i++)
+    REQUIRE(tree[i] == (i % 2 == 0));
+}
+
+template <class Tree>
+void checkOddKeyRace(Tree& tree, int numThreads, int keys, int rounds) {
+  checkOddKeyRace(tree, numThreads, keys, rounds,
+                  [](const std::atomic<int>&) {});
+}
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+"""Compares two Google Benchmark JSON outputs and reports regressions.
+
+Runs are matched by workload, tree, thread count and, for files written by
+tools/run_benchmarks.py, binary and pinning. Each pair is checked with
+Welch's t-test, on the individual repetitions when the file has them and on
+mean, stddev and repetition count otherwise. A pair is a regression when
+the contender is slower by more than --threshold and the difference is
+significant at --alpha. Exits with 1 if there is any regression.
+
+    tools/compare_benchmarks.py baseline.json contender.json --threshold 0.05
+"""
+
+import argparse
+import json
+import math
+import re
+import sys
+
+TO_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def key_of(entry):
+    """(binary, pinning, workload, tree, threads) of a run, the benchmark
+    arguments are part of the workload"""
+    base, *parts = entry["run_name"].split("/")
+    workload, _, tree = base.partition("<")
+    args = [part for part in parts if part.lstrip("-").isdigit()]
+    return (entry.get("binary", ""), entry.get("pinning", ""),
+            "/".join([workload] + args), tree[:-1] if tree else "",
+            int(entry.get("threads", 1)))
+
+
+def describe(key):
+    binary, pinning, workload, tree, threads = key
+    workload, *args = workload.split("/")
+    name = "/".join(["%s<%s>" % (workload, tree) if tree else workload] +
+                    args + ["threads:%d" % threads])
+    extra = "/".join(part for part in (binary, pinning) if part)
+    return name + (" [%s]" % extra if extra else "")
+
+
+class Sample:
+    """Mean, variance and size of the repetitions of one run"""
+
+    def __init__(self, mean, variance, n):
+        self.mean, self.variance, self.n = mean, variance, n
+
+    @staticmethod
+    def of(values):
+        n = len(values)
+        mean = sum(values) / n
+        variance = sum((v - mean)**2 for v in values) / (n - 1) if n > 1 else 0.0
+        return Sample(mean, variance, n)
+
+
+def load(path, metric):
+    with open(path) as f:
+        benchmarks = json.load(f)["benchmarks"]
+
+    iterations, aggregates = {}, {}
+    for entry in benchmarks:
+        if entry.get("error_occurred"):
+            continue
+        value = entry[metric] * TO_NS[entry.get("time_unit", "ns")]
+        key = key_of(entry)
+        if entry.get("run_type", "iteration") == "iteration":
+            iterations.setdefault(key, []).append(value)
+        else:
+            aggregates.setdefault(key, {})[entry["aggregate_name"]] = (
+                value, int(entry.get("repetitions", 1)))
+
+    samples = {key: Sample.of(values) for key, values in iterations.items()}
+    for key, stats in aggregates.items():
+        if key in samples or "mean" not in stats:
+            continue
+        mean, n = stats["mean"]
+        stddev = stats.get("stddev", (0.0, n))[0]
+        samples[key] = Sample(mean, stddev**2, n)
+    return samples
+
+
+def betacf(a, b, x):
+    """Continued fraction of the incomplete beta function (Lentz)"""
+    tiny = 1e-300
+    c, d = 1.0, 1.0 - (a + b) * x / (a + 1.0)
+    d = 1.0 / (d if abs(d) > tiny else tiny)
+    h = d
+    for m in range(1, 300):
+        m2 = 2 * m
+        for numerator in (m * (b - m) * x / ((a + m2 - 1.0) * (a + m2)),
+                          -(a + m) * (a + b + m) * x / ((a + m2) *
+                                                        (a + m2 + 1.0))):
+            d = 1.0 + numerator * d
+            d = 1.0 / (d if abs(d) > tiny else tiny)
+            c = 1.0 + numerator / c
+            c = c if abs(c) > tiny else tiny
+            h *= d * c
+        if abs(d * c - 1.0) < 1e-12:
+            break
+    return h
+
+
+def incomplete_beta(a, b, x):
+    """Regularised incomplete beta function I_x(a, b)"""
+    if x <= 0.0:
+        return 0.0
+    if x >= 1.0:
+        return 1.0
+    front = math.exp(
+        math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b) +
+        a * math.log(x) + b * math.log(1.0 - x))
+    if x < (a + 1.0) / (a + b + 2.0):
+        return front * betacf(a, b, x) / a
+    return 1.0 - front * betacf(b, a, 1.0 - x) / b
+
+
+def welch(old, new):
+    """Two sided p-value of Welch's t-test, 1 if it cannot be computed"""
+    if old.n < 2 or new.n < 2:
+        return 1.0
+    se_old, se_new = old.variance / old.n, new.variance / new.n
+    se = se_old + se_new
+    if se == 0.0:
+        return 0.0 if old.mean != new.mean else 1.0
+    t = (new.mean - old.mean) / math.sqrt(se)
+    df = se**2 / (se_old**2 / (old.n - 1) + se_new**2 / (new.n - 1))
+    return incomplete_beta(df / 2.0, 0.5, df / (df + t * t))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--metric", default="real_time",
+                        choices=["real_time", "cpu_time"])
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="relative slowdown that counts as a regression")
+    parser.add_argument("--alpha", type=float, default=0.05,
+                        help="significance level of the t-test")
+    parser.add_argument("--filter", default="",
+                        help="only compare runs whose name matches")
+    args = parser.parse_args()
+
+    old = load(args.baseline, args.metric)
+    new = load(args.contender, args.metric)
+    pattern = re.compile(args.filter)
+    keys = sorted(k for k in old.keys() & new.keys()
+                  if pattern.search(describe(k)))
+
+    rows, regressions = [], 0
+    for key in keys:
+        change = (new[key].mean - old[key].mean) / old[key].mean
+        p = welch(old[key], new[key])
+        if p >= args.alpha:
+            verdict = ""
+        elif change > args.threshold:
+            verdict = "REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            verdict = "improvement"
+        else:
+            verdict = ""
+        rows.append((describe(key), "%.0f" % old[key].mean,
+                     "%.0f" % new[key].mean, "%+.1f%%" % (100 * change),
+                     "%.3f" % p, verdict))
+
+    header = ("benchmark", "baseline ns", "contender ns", "change", "p",
+              "verdict")
+    widths = [max(len(row[i]) for row in rows + [header])
+              for i in range(len(header))]
+    for row in [header] + rows:
+        print("  ".join(cell.ljust(w) if i == 0 else cell.rjust(w)
+                        for i, (cell, w) in enumerate(zip(row, widths))))
+
+    for name, missing in (("contender", old.keys() - new.keys()),
+                          ("baseline", new.keys() - old.keys())):
+        for key in sorted(missing):
+            if pattern.search(describe(key)):
+                print("missing in %s: %s" % (name, describe(key)))
+
+    print("\n%d compared, %d regressions beyond %.1f%% at alpha %g" %
+          (len(rows), regressions, 100 * args.threshold, args.alpha))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Runs the benchmark matrix and merges the results into one JSON and CSV.
+
+Every benchmark binary is run once per pinning mode with warmup and
+repetitions, Google Benchmark reports mean, median, stddev and cv of the
+repetitions. The JSON keeps the Google Benchmark layout, with the pinning,
+placement and seed of each run added to its entries.
+
+    tools/run_benchmarks.py --build build --out results.json --csv results.csv
+"""
+
+import argparse
+import csv
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+DEFAULT_BENCHMARKS = ["BenchmarkBST", "BenchmarkBSTImbalanced"]
+CSV_FIELDS = [
+    "binary", "name", "workload", "tree", "threads", "pinning", "placement",
+    "seed", "aggregate", "real_time", "cpu_time", "time_unit",
+    "items_per_second", "bytes_per_key"
+]
+
+
+def split_name(run_name):
+    """BM_READ_WRITE<NatarajanBST<int>>/threads:4 -> workload, tree"""
+    base = run_name.split("/")[0]
+    if "<" not in base:
+        return base, ""
+    workload, tree = base.split("<", 1)
+    return workload, tree[:-1]
+
+
+def run(binary, args, env):
+    with tempfile.NamedTemporaryFile(suffix=".json") as out:
+        command = [
+            binary,
+            "--benchmark_out=" + out.name,
+            "--benchmark_out_format=json",
+            "--benchmark_repetitions=%d" % args.repetitions,
+            "--benchmark_min_warmup_time=%g" % args.warmup,
+            "--benchmark_report_aggregates_only=true",
+        ]
+        if args.min_time is not None:
+            command.append("--benchmark_min_time=%gs" % args.min_time)
+        if args.filter:
+            command.append("--benchmark_filter=" + args.filter)
+        print(" ".join(command), "#", env["BENCHMARK_PINNING"] or "unpinned",
+              file=sys.stderr)
+        subprocess.run(command, env=env, check=True,
+                       stdout=subprocess.DEVNULL)
+        with open(out.name) as f:
+            return json.load(f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--build", default="build",
+                        help="directory holding the benchmark binaries")
+    parser.add_argument("--benchmarks", default=",".join(DEFAULT_BENCHMARKS),
+                        help="comma separated benchmark binaries")
+    parser.add_argument("--pinning", default="compact,scatter",
+                        help="comma separated modes, 'none' for unpinned")
+    parser.add_argument("--placement", default="local",
+                        help="placement of shared trees, local or interleave")
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--warmup", type=float, default=0.5,
+                        help="seconds of warmup before each benchmark")
+    parser.add_argument("--min-time", type=float, default=None,
+                        help="minimum seconds per repetition")
+    parser.add_argument("--seed", type=int, default=42,
+                        help="seed of the randomised prefills")
+    parser.add_argument("--filter", default="",
+                        help="--benchmark_filter passed to every binary")
+    parser.add_argument("--out", required=True, help="merged JSON output")
+    parser.add_argument("--csv", help="CSV output, one row per aggregate")
+    args = parser.parse_args()
+
+    merged = {"context": None, "benchmarks": []}
+    for name in args.benchmarks.split(","):
+        binary = os.path.join(args.build, name)
+        for pinning in args.pinning.split(","):
+            pinning = "" if pinning == "none" else pinning
+            env = dict(os.environ,
+                       BENCHMARK_PINNING=pinning,
+                       BENCHMARK_PLACEMENT=args.placement,
+                       BENCHMARK_SEED=str(args.seed))
+            result = run(binary, args, env)
+            if merged["context"] is None:
+                merged["context"] = result["context"]
+            for entry in result["benchmarks"]:
+                entry["binary"] = name
+                entry["pinning"] = pinning or "none"
+                entry["placement"] = args.placement
+                entry["seed"] = args.seed
+                merged["benchmarks"].append(entry)
+
+    merged["context"]["repetitions"] = args.repetitions
+    merged["context"]["warmup_time"] = args.warmup
+    with open(args.out, "w") as f:
+        json.dump(merged, f, indent=2)
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=CSV_FIELDS,
+                                    extrasaction="ignore")
+            writer.writeheader()
+            for entry in merged["benchmarks"]:
+                workload, tree = split_name(entry["run_name"])
+                writer.writerow(dict(entry,
+                                     workload=workload,
+                                     tree=tree,
+                                     aggregate=entry.get("aggregate_name", "")))
+
+
+if __name__ == "__main__":
+    main()